@@ -0,0 +1,362 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include <trialfuncs.h>
+
+#include "aggregate.h"
+#include "registry.h"
+
+#define MAX_WINDOW_PANES (1 << 20) // Limit of pane ring, gcd(size, slide) shouldn't be too small
+#define SUMMARY_MAX 2048           // Space for window summary, fits four values of any type
+
+struct _pane
+{
+    long long count;  // Number of successful values
+    long long failed; // Number of failed values
+
+    /// @brief Sum of successful values, accumulated in wider type. Number of true values for bool
+    union
+    {
+        long long i_val;
+        unsigned long long ui_val;
+        double d_val;
+        long long b_val;
+    } sum;
+
+    value_t product; // Product of successful values, integers wrap around
+    value_t min;     // Minimum of successful values
+    value_t max;     // Maximum of successful values
+};
+
+/// @brief Partial aggregate of the pane or the whole window
+typedef struct _pane pane_t;
+
+struct _aggregate_type_ops
+{
+    /// @brief Reset aggregate to identity values
+    void (*init)(pane_t *pane);
+
+    /// @brief Reduce range of column into aggregate
+    void (*reduce)(pane_t *pane, const value_column_t *col, int begin, int count);
+
+    /// @brief Combine aggregates
+    void (*merge)(pane_t *dst, const pane_t *src);
+
+    /// @brief Format sum, product, min and max
+    /// @return Length of formatted text
+    int (*format)(const pane_t *pane, char *buff, size_t size);
+};
+
+typedef struct _aggregate_type_ops aggregate_type_ops_t;
+
+struct _aggregate
+{
+    window_spec_t spec;              // Window configuration
+    tf_result_t type;                // Type of aggregated values
+    const aggregate_type_ops_t *ops; // Operations for the type of values
+    output_t *out;                   // Output of summaries, ordered with other results
+    long long pane_size;             // Pane size, gcd(size, slide)
+    int window_panes;                // Number of panes in window
+    int slide_panes;                 // Number of panes between window starts
+    pane_t *panes;                   // Circular buffer of the last closed panes
+    long long closed;                // Number of closed panes
+    long long emitted;               // Number of closed panes at the last summary
+    pane_t current;                  // Open pane
+    long long current_fill;          // Number of values in open pane, for count windows
+    long long start;                 // Start time of the first pane, microseconds, for time windows
+};
+
+// Aggregated types - X(type id, C type, TYPESTR() of trialfuncs, value_t member, sum type, sum format, multiplication type, multiplication operator, min identity, max identity)
+// Product of bool values is conjunction
+#define FOREACH_AGGREGATE_TYPE(X)                                                                   \
+    X(TFR_INT, int, int, i_val, long long, "%lld", unsigned int, *, INT_MAX, INT_MIN)                  \
+    X(TFR_UINT, unsigned int, unsigned_int, ui_val, unsigned long long, "%llu", unsigned int, *, UINT_MAX, 0) \
+    X(TFR_FLOAT, double, double, d_val, double, "%lf", double, *, INFINITY, -INFINITY)                 \
+    X(TFR_BOOL, bool, _Bool, b_val, long long, "%lld", bool, &&, true, false)
+
+#define DEFINE_AGGREGATE_OPS(TFR, c_type, typestr, field, sum_type, sum_fmt, mul_type, mul_op, min_id, max_id) \
+    static void init_##typestr(pane_t *pane)                                                         \
+    {                                                                                                \
+        memset(pane, 0, sizeof(*pane));                                                              \
+        pane->product.field = 1;                                                                     \
+        pane->min.field = min_id;                                                                    \
+        pane->max.field = max_id;                                                                    \
+    }                                                                                                \
+                                                                                                     \
+    static void reduce_##typestr(pane_t *pane, const value_column_t *col, int begin, int count)     \
+    {                                                                                                \
+        const unsigned char *restrict status = col->status + begin;                                  \
+        const c_type *restrict data = col->field + begin;                                            \
+                                                                                                     \
+        long long ok = 0;                                                                            \
+        sum_type sum = 0;                                                                            \
+        mul_type product = pane->product.field;                                                      \
+        c_type min = pane->min.field;                                                                \
+        c_type max = pane->max.field;                                                                \
+                                                                                                     \
+        /* Failed values are replaced with identities, without branches */                          \
+        for (int i = 0; i < count; i++)                                                              \
+        {                                                                                            \
+            bool success = status[i] == COMPFUNC_SUCCESS;                                            \
+            ok += success;                                                                           \
+            sum += success ? data[i] : 0;                                                            \
+            product = product mul_op (success ? (mul_type)data[i] : 1);                              \
+            min = success && data[i] < min ? data[i] : min;                                          \
+            max = success && data[i] > max ? data[i] : max;                                          \
+        }                                                                                            \
+                                                                                                     \
+        pane->count += ok;                                                                           \
+        pane->failed += count - ok;                                                                  \
+        pane->sum.field += sum;                                                                      \
+        pane->product.field = product;                                                               \
+        pane->min.field = min;                                                                       \
+        pane->max.field = max;                                                                       \
+    }                                                                                                \
+                                                                                                     \
+    static void merge_##typestr(pane_t *dst, const pane_t *src)                                      \
+    {                                                                                                \
+        dst->count += src->count;                                                                    \
+        dst->failed += src->failed;                                                                  \
+        dst->sum.field += src->sum.field;                                                            \
+        dst->product.field = (mul_type)dst->product.field mul_op (mul_type)src->product.field;       \
+        dst->min.field = MIN(dst->min.field, src->min.field);                                        \
+        dst->max.field = MAX(dst->max.field, src->max.field);                                        \
+    }                                                                                                \
+                                                                                                     \
+    static int format_##typestr(const pane_t *pane, char *buff, size_t size)                        \
+    {                                                                                                \
+        int len = snprintf(buff, size, ", sum " sum_fmt, pane->sum.field);                           \
+                                                                                                     \
+        if (pane->count > 0)                                                                         \
+        {                                                                                            \
+            len += snprintf(buff + len, size - len, ", product ");                                   \
+            len += result_types[TFR].format(buff + len, size - len, &pane->product);                 \
+            len += snprintf(buff + len, size - len, ", min ");                                       \
+            len += result_types[TFR].format(buff + len, size - len, &pane->min);                     \
+            len += snprintf(buff + len, size - len, ", max ");                                       \
+            len += result_types[TFR].format(buff + len, size - len, &pane->max);                     \
+        }                                                                                            \
+                                                                                                     \
+        return len;                                                                                  \
+    }
+
+FOREACH_AGGREGATE_TYPE(DEFINE_AGGREGATE_OPS)
+
+#define AGGREGATE_OPS_ENTRY(TFR, c_type, typestr, field, ...) \
+    [TFR] = {init_##typestr, reduce_##typestr, merge_##typestr, format_##typestr},
+
+static const aggregate_type_ops_t aggregate_types[TFR_COUNT] = {
+    FOREACH_AGGREGATE_TYPE(AGGREGATE_OPS_ENTRY)
+};
+
+static long long gcd(long long a, long long b)
+{
+    while (b != 0)
+    {
+        long long t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+static long long elapsed_ms(const aggregate_t *agg)
+{
+    // Simulated time in virtual clock mode
+    return (trial_clock_usecs() - agg->start) / 1000;
+}
+
+bool parse_window_spec(const char *text, window_spec_t *spec)
+{
+    const char *sep = strchr(text, ':');
+
+    if (sep == NULL)
+    {
+        return false;
+    }
+
+    if (sep - text == 5 && strncmp(text, "count", 5) == 0)
+    {
+        spec->kind = WK_COUNT;
+    }
+    else if (sep - text == 4 && strncmp(text, "time", 4) == 0)
+    {
+        spec->kind = WK_TIME;
+    }
+    else
+    {
+        return false;
+    }
+
+    char *end;
+    spec->size = strtoll(sep + 1, &end, 10);
+    spec->slide = spec->size;
+
+    if (*end == ':')
+    {
+        spec->slide = strtoll(end + 1, &end, 10);
+    }
+
+    return *end == '\0' && spec->size > 0 && spec->slide > 0;
+}
+
+aggregate_t *construct_aggregate(const window_spec_t *spec, tf_result_t type, output_t *out)
+{
+    aggregate_t *agg = calloc(1, sizeof(aggregate_t));
+
+    if (agg == NULL)
+    {
+        return NULL;
+    }
+
+    agg->spec = *spec;
+    agg->type = type;
+    agg->ops = &aggregate_types[type];
+    agg->out = out;
+    agg->pane_size = gcd(spec->size, spec->slide);
+
+    if (spec->size / agg->pane_size > MAX_WINDOW_PANES || spec->slide / agg->pane_size > MAX_WINDOW_PANES)
+    {
+        fprintf(stderr, "aggregate: Window size and slide need common divisor, not less than %lld\n", spec->size / MAX_WINDOW_PANES + 1);
+        free(agg);
+        return NULL;
+    }
+
+    agg->window_panes = spec->size / agg->pane_size;
+    agg->slide_panes = spec->slide / agg->pane_size;
+    agg->panes = malloc(sizeof(pane_t) * agg->window_panes);
+
+    if (agg->panes == NULL)
+    {
+        free(agg);
+        return NULL;
+    }
+
+    agg->ops->init(&agg->current);
+    agg->start = trial_clock_usecs();
+
+    return agg;
+}
+
+void destruct_aggregate(aggregate_t *agg)
+{
+    free(agg->panes);
+    free(agg);
+}
+
+/// @brief Combine the last panes, output window summary
+static void print_window(aggregate_t *agg)
+{
+    long long n = MIN(agg->closed, agg->window_panes);
+    pane_t window;
+
+    agg->ops->init(&window);
+
+    for (long long i = agg->closed - n; i < agg->closed; i++)
+    {
+        agg->ops->merge(&window, &agg->panes[i % agg->window_panes]);
+    }
+
+    long long begin = (agg->closed - n) * agg->pane_size;
+    char summary[SUMMARY_MAX];
+    int len;
+
+    if (agg->spec.kind == WK_COUNT)
+    {
+        len = snprintf(summary, sizeof(summary), "Aggregate values [%lld, %lld)", begin, begin + window.count + window.failed);
+    }
+    else
+    {
+        len = snprintf(summary, sizeof(summary), "Aggregate time [%lld ms, %lld ms)", begin, MIN(agg->closed * agg->pane_size, elapsed_ms(agg)));
+    }
+
+    len += snprintf(summary + len, sizeof(summary) - len, ": count %lld, failed %lld", window.count, window.failed);
+
+    if (agg->type == TFR_BOOL)
+    {
+        snprintf(summary + len, sizeof(summary) - len, ", true %lld, false %lld", window.sum.b_val, window.count - window.sum.b_val);
+    }
+    else
+    {
+        agg->ops->format(&window, summary + len, sizeof(summary) - len);
+    }
+
+    output_window(agg->out, summary);
+
+    agg->emitted = agg->closed;
+}
+
+static void close_pane(aggregate_t *agg)
+{
+    agg->panes[agg->closed % agg->window_panes] = agg->current;
+    agg->closed++;
+    agg->ops->init(&agg->current);
+    agg->current_fill = 0;
+
+    // Window ends at this pane
+    if (agg->closed >= agg->window_panes && (agg->closed - agg->window_panes) % agg->slide_panes == 0)
+    {
+        print_window(agg);
+    }
+}
+
+void aggregate_column(aggregate_t *agg, const value_column_t *col, int begin, int count)
+{
+    if (agg->spec.kind == WK_TIME)
+    {
+        // Values belong to the pane of finalization time
+        aggregate_tick(agg);
+        agg->ops->reduce(&agg->current, col, begin, count);
+        return;
+    }
+
+    while (count > 0)
+    {
+        int chunk = MIN(count, agg->pane_size - agg->current_fill);
+
+        agg->ops->reduce(&agg->current, col, begin, chunk);
+        agg->current_fill += chunk;
+        begin += chunk;
+        count -= chunk;
+
+        if (agg->current_fill == agg->pane_size)
+        {
+            close_pane(agg);
+        }
+    }
+}
+
+void aggregate_tick(aggregate_t *agg)
+{
+    if (agg->spec.kind != WK_TIME)
+    {
+        return;
+    }
+
+    long long pane = elapsed_ms(agg) / agg->pane_size;
+
+    while (agg->closed < pane)
+    {
+        close_pane(agg);
+    }
+}
+
+void aggregate_finish(aggregate_t *agg)
+{
+    aggregate_tick(agg);
+
+    if (agg->current.count + agg->current.failed > 0)
+    {
+        close_pane(agg);
+
+        if (agg->emitted != agg->closed)
+        {
+            print_window(agg);
+        }
+    }
+}
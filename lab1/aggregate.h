@@ -0,0 +1,68 @@
+#ifndef __AGGREGATE_INC__
+#define __AGGREGATE_INC__
+
+#include <stdbool.h>
+
+#include "output.h"
+#include "result_store.h"
+#include "shared_data.h"
+
+enum _window_kind
+{
+    WK_COUNT, // Window size in number of values
+    WK_TIME,  // Window size in milliseconds
+};
+
+typedef enum _window_kind window_kind_t;
+
+struct _window_spec
+{
+    window_kind_t kind; // Units of size and slide
+    long long size;     // Window size
+    long long slide;    // Distance between window starts, equal to size for tumbling windows
+};
+
+/// @brief Window configuration, count:<size>[:<slide>] or time:<ms>[:<slide_ms>]
+typedef struct _window_spec window_spec_t;
+
+/// @brief Streaming aggregation of final results, over tumbling or sliding windows.
+///
+/// Window is split in panes of gcd(size, slide) units, each final value is reduced once
+/// into the current pane, window summary combines the last panes of the window.
+/// Only summaries are printed: number of values, failures, and sum, product, min, max
+/// of numeric results or number of true and false results.
+typedef struct _aggregate aggregate_t;
+
+/// @brief Parse window configuration
+/// @param text Window specification, from command line
+/// @param spec Parsed configuration
+/// @return True, on success
+bool parse_window_spec(const char *text, window_spec_t *spec);
+
+/// @brief Create aggregation
+/// @param spec Window configuration
+/// @param type Type of aggregated values
+/// @param out  Output of summaries
+/// @return Aggregation instance, NULL on failure
+aggregate_t *construct_aggregate(const window_spec_t *spec, tf_result_t type, output_t *out);
+
+/// @brief Release aggregation
+/// @param agg Aggregation allocated by construct_aggregate()
+void destruct_aggregate(aggregate_t *agg);
+
+/// @brief Reduce range of finalized values, print summaries of completed windows
+/// @param agg   Aggregation
+/// @param col   Final results
+/// @param begin Index of the first value
+/// @param count Number of values
+void aggregate_column(aggregate_t *agg, const value_column_t *col, int begin, int count);
+
+/// @brief Close time panes, print summaries of elapsed windows
+/// @param agg Aggregation
+void aggregate_tick(aggregate_t *agg);
+
+/// @brief Print summary of the last incomplete window
+/// @param agg Aggregation
+void aggregate_finish(aggregate_t *agg);
+
+#endif // __AGGREGATE_INC__
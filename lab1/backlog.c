@@ -0,0 +1,268 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+
+#include "backlog.h"
+
+struct _segment
+{
+    int *data;             // Values, NULL while spilled segment is not mapped
+    int count;             // Number of written values
+    int read_pos;          // Index of the first value to pop
+    int fd;                // Spill file, -1 for memory segment
+    struct _segment *next; // Next segment, towards the tail
+};
+
+typedef struct _segment segment_t;
+
+struct _backlog
+{
+    segment_t *head;        // Segment for reading
+    segment_t *tail;        // Segment for writing
+    int segment_size;       // Number of values in segment
+    int memory_segments;    // Maximal number of memory segments, before spill
+    int allocated_segments; // Number of memory segments
+    long long size;         // Number of values
+    long long spilled;      // Number of values in spilled segments
+    char *spill_dir;        // Directory for spill files, NULL if spill is disabled
+};
+
+backlog_t *construct_backlog(int segment_size, long long memory_values, const char *spill_dir)
+{
+    backlog_t *bl = calloc(1, sizeof(backlog_t));
+
+    if (bl == NULL)
+    {
+        return NULL;
+    }
+
+    bl->segment_size = segment_size;
+    // Head and tail segments are always in memory
+    bl->memory_segments = MAX(2, memory_values / segment_size);
+    bl->spill_dir = spill_dir ? strdup(spill_dir) : NULL;
+
+    return bl;
+}
+
+static size_t segment_bytes(const backlog_t *bl)
+{
+    return sizeof(int) * bl->segment_size;
+}
+
+static void free_segment(backlog_t *bl, segment_t *seg)
+{
+    if (seg->fd == -1)
+    {
+        free(seg->data);
+        bl->allocated_segments--;
+    }
+    else
+    {
+        if (seg->data != NULL)
+        {
+            munmap(seg->data, segment_bytes(bl));
+        }
+        close(seg->fd);
+    }
+
+    free(seg);
+}
+
+void destruct_backlog(backlog_t *bl)
+{
+    while (bl->head != NULL)
+    {
+        segment_t *next = bl->head->next;
+        free_segment(bl, bl->head);
+        bl->head = next;
+    }
+
+    free(bl->spill_dir);
+    free(bl);
+}
+
+/// @brief Create file backed segment, file is unlinked and lives while it is open
+static bool map_spill_segment(backlog_t *bl, segment_t *seg)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/backlog_XXXXXX", bl->spill_dir);
+
+    seg->fd = mkstemp(path);
+    if (seg->fd == -1)
+    {
+        return false;
+    }
+
+    unlink(path);
+
+    if (ftruncate(seg->fd, segment_bytes(bl)) == -1)
+    {
+        close(seg->fd);
+        return false;
+    }
+
+    seg->data = mmap(NULL, segment_bytes(bl), PROT_READ | PROT_WRITE, MAP_SHARED, seg->fd, 0);
+    if (seg->data == MAP_FAILED)
+    {
+        close(seg->fd);
+        return false;
+    }
+
+    return true;
+}
+
+static segment_t *append_segment(backlog_t *bl)
+{
+    segment_t *seg = calloc(1, sizeof(segment_t));
+
+    if (seg == NULL)
+    {
+        return NULL;
+    }
+
+    seg->fd = -1;
+
+    if (bl->spill_dir != NULL && bl->allocated_segments >= bl->memory_segments && bl->head != NULL)
+    {
+        // Cold segment, written through memory map and unmapped when full
+        if (!map_spill_segment(bl, seg))
+        {
+            fprintf(stderr, "backlog: spill to %s failed, keep values in memory\n", bl->spill_dir);
+            seg->fd = -1;
+        }
+    }
+
+    if (seg->fd == -1)
+    {
+        seg->data = malloc(segment_bytes(bl));
+        if (seg->data == NULL)
+        {
+            free(seg);
+            return NULL;
+        }
+        bl->allocated_segments++;
+    }
+
+    if (bl->tail != NULL)
+    {
+        bl->tail->next = seg;
+    }
+    else
+    {
+        bl->head = seg;
+    }
+
+    bl->tail = seg;
+
+    return seg;
+}
+
+/// @brief Release pages of filled spill segment, until it reaches the head
+static void unmap_spill_segment(backlog_t *bl, segment_t *seg)
+{
+    if (seg->fd != -1 && seg != bl->head)
+    {
+        munmap(seg->data, segment_bytes(bl));
+        seg->data = NULL;
+        bl->spilled += seg->count;
+    }
+}
+
+bool backlog_push(backlog_t *bl, const int *values, int count)
+{
+    while (count > 0)
+    {
+        segment_t *seg = bl->tail;
+
+        if (seg == NULL || seg->count == bl->segment_size)
+        {
+            seg = append_segment(bl);
+            if (seg == NULL)
+            {
+                return false;
+            }
+        }
+
+        int chunk = MIN(count, bl->segment_size - seg->count);
+        memcpy(seg->data + seg->count, values, sizeof(int) * chunk);
+        seg->count += chunk;
+        bl->size += chunk;
+        values += chunk;
+        count -= chunk;
+
+        if (seg->count == bl->segment_size)
+        {
+            unmap_spill_segment(bl, seg);
+        }
+    }
+
+    return true;
+}
+
+int backlog_pop(backlog_t *bl, int *values, int max)
+{
+    int result = 0;
+
+    while (result < max && bl->head != NULL)
+    {
+        segment_t *seg = bl->head;
+
+        if (seg->data == NULL)
+        {
+            // Spilled segment reached the head, map it back
+            seg->data = mmap(NULL, segment_bytes(bl), PROT_READ, MAP_PRIVATE, seg->fd, 0);
+            if (seg->data == MAP_FAILED)
+            {
+                seg->data = NULL;
+                fprintf(stderr, "backlog: failed to map spilled segment\n");
+                break;
+            }
+            madvise(seg->data, segment_bytes(bl), MADV_SEQUENTIAL);
+            bl->spilled -= seg->count;
+        }
+
+        int chunk = MIN(max - result, seg->count - seg->read_pos);
+        memcpy(values + result, seg->data + seg->read_pos, sizeof(int) * chunk);
+        seg->read_pos += chunk;
+        bl->size -= chunk;
+        result += chunk;
+
+        if (seg->read_pos == seg->count)
+        {
+            if (seg == bl->tail)
+            {
+                // Reuse the last segment for writing
+                seg->read_pos = 0;
+                seg->count = 0;
+
+                if (seg->fd != -1 && seg->data != NULL)
+                {
+                    // Mapped read only, replace with memory segment on next push
+                    munmap(seg->data, segment_bytes(bl));
+                    close(seg->fd);
+                    bl->head = bl->tail = NULL;
+                    free(seg);
+                }
+                break;
+            }
+
+            bl->head = seg->next;
+            free_segment(bl, seg);
+        }
+    }
+
+    return result;
+}
+
+long long backlog_size(const backlog_t *bl)
+{
+    return bl->size;
+}
+
+long long backlog_spilled(const backlog_t *bl)
+{
+    return bl->spilled;
+}
@@ -0,0 +1,45 @@
+#ifndef __BACKLOG_INC__
+#define __BACKLOG_INC__
+
+#include <stdbool.h>
+
+/// @brief Unbounded FIFO of input values, waiting for free space in manager queue.
+///
+/// Values are stored in fixed size segments. Segments close to the head stay in memory,
+/// cold segments are kept in memory mapped files of spill directory, if it is configured.
+typedef struct _backlog backlog_t;
+
+/// @brief Create backlog
+/// @param segment_size   Number of values in segment
+/// @param memory_values  Number of values kept in memory, rest is spilled to disk
+/// @param spill_dir      Directory for spill files, NULL to keep everything in memory
+/// @return Backlog instance, NULL on failure
+backlog_t *construct_backlog(int segment_size, long long memory_values, const char *spill_dir);
+
+/// @brief Release memory, close and remove spill files
+/// @param bl Backlog allocated by construct_backlog()
+void destruct_backlog(backlog_t *bl);
+
+/// @brief Append values
+/// @param bl     Backlog
+/// @param values Values
+/// @param count  Number of values
+/// @return True, on success
+bool backlog_push(backlog_t *bl, const int *values, int count);
+
+/// @brief Take values from the head
+/// @param bl     Backlog
+/// @param values Destination
+/// @param max    Maximal number of values
+/// @return Number of values
+int backlog_pop(backlog_t *bl, int *values, int max);
+
+/// @brief Number of values in backlog
+/// @param bl Backlog
+long long backlog_size(const backlog_t *bl);
+
+/// @brief Number of values in spilled segments
+/// @param bl Backlog
+long long backlog_spilled(const backlog_t *bl);
+
+#endif // __BACKLOG_INC__
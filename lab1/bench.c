@@ -0,0 +1,335 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "backlog.h"
+#include "input_parser.h"
+#include "registry.h"
+#include "result_store.h"
+#include "shared_data.h"
+
+#define BENCH_MIN_TIME 50000000LL // Minimal duration of measured run, nanoseconds
+#define BENCH_RUNS 5              // Measured runs, the best one is reported
+#define QUEUE_SMALL 100           // Default queue size of manager
+#define QUEUE_LARGE 65536         // Large queue size
+#define PARSE_CHUNK (1 << 20)     // Input chunk, as read or mapped by manager
+
+/// @brief Run benchmarked operation
+/// @param ctx        Benchmark data
+/// @param iterations Number of repetitions
+typedef void (*bench_func_t)(void *ctx, long long iterations);
+
+static volatile long long sink; // Keeps results of benchmarked operations alive
+
+static long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/// @brief Measure operation, print JSON line
+/// @param name  Benchmark name
+/// @param cse   Benchmark case
+/// @param func  Benchmarked operation
+/// @param ctx   Benchmark data
+/// @param items Items processed by single iteration
+static void run_bench(const char *name, const char *cse, bench_func_t func, void *ctx, long long items)
+{
+    long long iterations = 1;
+
+    // Calibrate, single run should be long enough for timer resolution
+    while (true)
+    {
+        long long begin = now_ns();
+        func(ctx, iterations);
+        if (now_ns() - begin >= BENCH_MIN_TIME)
+        {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    long long best = -1;
+
+    for (int i = 0; i < BENCH_RUNS; i++)
+    {
+        long long begin = now_ns();
+        func(ctx, iterations);
+        long long elapsed = now_ns() - begin;
+
+        if (best == -1 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+
+    double ns_per_item = (double)best / (iterations * items);
+
+    printf("{\"benchmark\":\"%s\",\"case\":\"%s\",\"iterations\":%lld,\"items\":%lld,\"ns_per_item\":%.3f,\"items_per_sec\":%.0f}\n",
+           name, cse, iterations, items, ns_per_item, 1e9 / ns_per_item);
+    fflush(stdout);
+}
+
+static void bench_function_from_name(void *ctx, long long iterations)
+{
+    const char *name = ctx;
+    long long sum = 0;
+
+    for (long long i = 0; i < iterations; i++)
+    {
+        sum += function_from_name(name);
+    }
+
+    sink = sum;
+}
+
+struct _column_bench
+{
+    value_column_t src[2];   // Operands
+    value_column_t dst;      // Result
+    column_cast_func_t cast; // Cast kernel, NULL for final operation
+    final_op_func_t final;   // Final operation kernel, NULL for cast
+    int count;               // Number of values in columns
+};
+
+typedef struct _column_bench column_bench_t;
+
+/// @brief Fill column with successful values, every 16th value is failed
+static void fill_column(value_column_t *col, tf_result_t type, int count)
+{
+    column_init(col, type, count);
+
+    for (int i = 0; i < count; i++)
+    {
+        value_t val;
+        memset(&val, 0, sizeof(val));
+        val.status = i % 16 == 15 ? COMPFUNC_HARD_FAIL : COMPFUNC_SUCCESS;
+
+        switch (type)
+        {
+        case TFR_INT:
+            val.i_val = i % 1000 - 500;
+            break;
+        case TFR_UINT:
+            val.ui_val = i % 1000;
+            break;
+        case TFR_FLOAT:
+            val.d_val = (i % 1000) * 0.5;
+            break;
+        case TFR_BOOL:
+            val.b_val = i % 3 == 0;
+            break;
+        default:
+            break;
+        }
+
+        result_types[type].store(col, i, &val);
+    }
+}
+
+static void bench_column(void *ctx, long long iterations)
+{
+    column_bench_t *cb = ctx;
+
+    for (long long i = 0; i < iterations; i++)
+    {
+        if (cb->cast != NULL)
+        {
+            cb->cast(&cb->src[0], &cb->dst, 0, cb->count);
+        }
+        else
+        {
+            cb->final(&cb->src[0], &cb->src[1], &cb->dst, 0, cb->count);
+        }
+    }
+
+    sink = cb->dst.status[cb->count - 1];
+}
+
+static void bench_store_load(void *ctx, long long iterations)
+{
+    column_bench_t *cb = ctx;
+    const result_type_ops_t *ops = &result_types[cb->dst.type];
+    long long sum = 0;
+
+    // Per-value path of received results and printed final results
+    for (long long i = 0; i < iterations; i++)
+    {
+        for (int pos = 0; pos < cb->count; pos++)
+        {
+            value_t val;
+            ops->load(&cb->src[0], pos, &val);
+            ops->store(&cb->dst, pos, &val);
+            sum += val.status;
+        }
+    }
+
+    sink = sum;
+}
+
+struct _parse_bench
+{
+    char *data;             // Input chunk
+    size_t len;             // Chunk length
+    input_parser_t *parser; // Parser
+    backlog_t *backlog;     // Parsed values
+    int *drain;             // Scratch buffer for popped values
+};
+
+typedef struct _parse_bench parse_bench_t;
+
+static void bench_parse(void *ctx, long long iterations)
+{
+    parse_bench_t *pb = ctx;
+
+    for (long long i = 0; i < iterations; i++)
+    {
+        input_parse(pb->parser, pb->data, pb->len, pb->backlog);
+
+        while (backlog_pop(pb->backlog, pb->drain, QUEUE_LARGE) > 0)
+        {
+        }
+    }
+
+    sink = pb->drain[0];
+}
+
+static void run_parse_bench(bool binary)
+{
+    parse_bench_t pb;
+    long long values = 0;
+
+    pb.data = malloc(PARSE_CHUNK);
+    pb.len = 0;
+    pb.drain = malloc(sizeof(int) * QUEUE_LARGE);
+
+    // Whole values only, chunks are parsed one after another
+    srand(25);
+
+    while (true)
+    {
+        int x = rand() % 200001 - 100000;
+
+        if (binary)
+        {
+            if (pb.len + sizeof(int) > PARSE_CHUNK)
+            {
+                break;
+            }
+            memcpy(pb.data + pb.len, &x, sizeof(int));
+            pb.len += sizeof(int);
+        }
+        else
+        {
+            char line[16];
+            int len = snprintf(line, sizeof(line), "%d\n", x);
+
+            if (pb.len + len > PARSE_CHUNK)
+            {
+                break;
+            }
+            memcpy(pb.data + pb.len, line, len);
+            pb.len += len;
+        }
+
+        values++;
+    }
+
+    pb.parser = construct_input_parser(binary);
+    pb.backlog = construct_backlog(QUEUE_LARGE, 1LL << 22, NULL);
+
+    run_bench("input_parse", binary ? "binary" : "text", bench_parse, &pb, values);
+
+    destruct_input_parser(pb.parser);
+    destruct_backlog(pb.backlog);
+    free(pb.data);
+    free(pb.drain);
+}
+
+int main(void)
+{
+    // Name lookup, at startup of manager and calculon
+    for (trial_function_t tf = 0; tf < TF_COUNT; tf++)
+    {
+        run_bench("function_from_name", tf_name(tf), bench_function_from_name, (void *)tf_name(tf), 1);
+    }
+    run_bench("function_from_name", "unknown", bench_function_from_name, "unknown", 1);
+
+    // Cast kernels of final calculation
+    for (tf_result_t src = 0; src < TFR_COUNT; src++)
+    {
+        for (tf_result_t dst = 0; dst < TFR_COUNT; dst++)
+        {
+            if (column_casts[src][dst] == NULL)
+            {
+                continue;
+            }
+
+            column_bench_t cb;
+            char cse[64];
+
+            memset(&cb, 0, sizeof(cb));
+            cb.count = QUEUE_LARGE;
+            cb.cast = column_casts[src][dst];
+            fill_column(&cb.src[0], src, cb.count);
+            column_init(&cb.dst, dst, cb.count);
+
+            snprintf(cse, sizeof(cse), "%s_to_%s", result_types[src].name, result_types[dst].name);
+            run_bench("column_cast", cse, bench_column, &cb, cb.count);
+
+            column_free(&cb.src[0]);
+            column_free(&cb.dst);
+        }
+    }
+
+    // Final operation kernels over full queues
+    int queue_sizes[] = {QUEUE_SMALL, QUEUE_LARGE};
+
+    for (trial_function_t tf = 0; tf < TF_COUNT; tf++)
+    {
+        for (size_t q = 0; q < sizeof(queue_sizes) / sizeof(queue_sizes[0]); q++)
+        {
+            column_bench_t cb;
+            char cse[64];
+            tf_result_t type = trial_result_type(tf);
+
+            memset(&cb, 0, sizeof(cb));
+            cb.count = queue_sizes[q];
+            cb.final = trial_ops[tf].final;
+            fill_column(&cb.src[0], type, cb.count);
+            fill_column(&cb.src[1], type, cb.count);
+            column_init(&cb.dst, type, cb.count);
+
+            snprintf(cse, sizeof(cse), "%s_queue_%d", tf_name(tf), cb.count);
+            run_bench("final_op", cse, bench_column, &cb, cb.count);
+
+            column_free(&cb.src[0]);
+            column_free(&cb.src[1]);
+            column_free(&cb.dst);
+        }
+    }
+
+    // Per-value registry operations
+    for (tf_result_t type = 0; type < TFR_COUNT; type++)
+    {
+        column_bench_t cb;
+
+        memset(&cb, 0, sizeof(cb));
+        cb.count = QUEUE_LARGE;
+        fill_column(&cb.src[0], type, cb.count);
+        column_init(&cb.dst, type, cb.count);
+
+        run_bench("value_store_load", result_types[type].name, bench_store_load, &cb, cb.count);
+
+        column_free(&cb.src[0]);
+        column_free(&cb.dst);
+    }
+
+    // Input stream
+    run_parse_bench(false);
+    run_parse_bench(true);
+
+    return 0;
+}
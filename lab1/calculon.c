@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -7,7 +8,10 @@
 
 #include <trialfuncs.h>
 
+#include "record.h"
+#include "registry.h"
 #include "shared_data.h"
+#include "tracer.h"
 
 
 void handle_interrupt()
@@ -17,60 +21,154 @@ void handle_interrupt()
 
 int main(int argc, char **argv)
 {
-    if (argc != 3)
+    char *trace_file = NULL;
+    const char *record_file = NULL;
+    const char *clock_file = NULL;
+    const char *cases_file = NULL;
+    const char *faults = NULL;
+    int trace_sample = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "t:w:V:C:F:")) != -1)
     {
-        fprintf(stdout, "Usage: %s <f or g> <function>\n", argv[0]);
+        switch (opt)
+        {
+        case 't':
+        {
+            // Trace file of manager, with sample rate
+            trace_file = optarg;
+            char *sample = strrchr(optarg, ':');
+            if (sample != NULL)
+            {
+                *sample = '\0';
+                trace_sample = atoi(sample + 1);
+            }
+            break;
+        }
+        case 'w':
+            record_file = optarg;
+            break;
+        case 'V':
+            clock_file = optarg;
+            break;
+        case 'C':
+            cases_file = optarg;
+            break;
+        case 'F':
+            faults = optarg;
+            break;
+        default:
+            argc = 0;
+            break;
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc != 2 && argc != 4)
+    {
+        fprintf(stdout, "Usage: calculon [-t <trace_file>[:<sample>]] [-w <record_file>] [-V <clock_file>] [-C <cases_file>] [-F <faults>] <f or g> <function> [<x_pipe> <result_pipe>]\n");
         return 1;
     }
 
     computation_node node = NODES_COUNT; // Unknown node type
 
-    if (strcmp("f", argv[1]) == 0)
+    if (strcmp("f", argv[0]) == 0)
     {
         node = F_NODE;
     }
-    else if (strcmp("g", argv[1]) == 0)
+    else if (strcmp("g", argv[0]) == 0)
     {
         node = G_NODE;
     }
     else
     {
-        fprintf(stderr, "Invalid node type - %s\n", argv[1]);
+        fprintf(stderr, "Invalid node type - %s\n", argv[0]);
         return 1;
     }
 
-    trial_function_t tf = function_from_name(argv[2]);
+    trial_function_t tf = function_from_name(argv[1]);
 
     if (tf == TF_UNKNOWN)
     {
-        fprintf(stderr, "Unknown trial function - %s\n", argv[2]);
+        fprintf(stderr, "Unknown trial function - %s\n", argv[1]);
         return 1;
     }
 
-    // input formats
+    // input formats, named pipes of the node by default, unique pipes of the worker pool otherwise
+    const char *x_pipe = argc == 4 ? argv[2] : node_pipe[node][0];
+    const char *result_pipe = argc == 4 ? argv[3] : node_pipe[node][1];
 
-    int comm_fd = open(node_pipe[node][0], O_RDONLY);
+    // Virtual clock is created by manager, delays advance simulated time.
+    // Manager opens pipes after attachment, it counts sent values for attached worker
+    if (clock_file != NULL && trial_clock_attach(clock_file) != 0)
+    {
+        fprintf(stderr, "Failed to attach virtual clock - %s\n", clock_file);
+        return 1;
+    }
+
+    int comm_fd = open(x_pipe, O_RDONLY);
     if (comm_fd == -1)
     {
-        fprintf(stderr, "Failed to open input named pipe - %s\n", node_pipe[node][0]);
+        fprintf(stderr, "Failed to open input named pipe - %s\n", x_pipe);
         return 1;
     }
 
-    int result_fd = open(node_pipe[node][1], O_WRONLY);
+    int result_fd = open(result_pipe, O_WRONLY);
     if (result_fd == -1)
     {
-        fprintf(stderr, "Failed to open result named pipe - %s\n", node_pipe[node][1]);
+        fprintf(stderr, "Failed to open result named pipe - %s\n", result_pipe);
+        return 1;
+    }
+
+    // Case tables replace compiled cases of trial functions
+    if (cases_file != NULL && trial_cases_load(cases_file) != 0)
+    {
+        fprintf(stderr, "Failed to load case tables - %s\n", cases_file);
         return 1;
     }
 
+    // Seeded faults, the same decisions for x in every run
+    if (faults != NULL && trial_faults_config(faults) != 0)
+    {
+        fprintf(stderr, "Invalid fault injection - %s\n", faults);
+        return 1;
+    }
+
+    // Trace file is created by manager, evaluation of sampled values is appended
+    tracer_t *tracer = NULL;
+
+    if (trace_file != NULL)
+    {
+        tracer = construct_tracer(trace_file, false, node == F_NODE ? "calculon f" : "calculon g", trace_sample);
+    }
+
+    // Results stream for replay worker
+    recorder_t *recorder = NULL;
+
+    if (record_file != NULL)
+    {
+        recorder = construct_recorder(record_file, node, argv[1]);
+        if (recorder == NULL)
+        {
+            fprintf(stderr, "Failed to create recording - %s\n", record_file);
+            return 1;
+        }
+    }
+
     // Process interrupt is handled by parent
     signal(SIGINT, handle_interrupt);
 
+    // Trial function implementation is resolved once, at startup
+    eval_batch_func_t eval = trial_ops[tf].eval[node];
+
     // listen for input
-    int buff[256];
+    int buff[EVAL_BATCH_MAX];
+    value_t results[EVAL_BATCH_MAX]; // Packed for data interchange
     while (1)
     {
-        // Blocking Input-Output operation
+        // Blocking Input-Output operation, virtual clock may advance while waiting
         int retval = read(comm_fd, buff, sizeof(buff));
         if (retval == -1)
         {
@@ -80,77 +178,65 @@ int main(int argc, char **argv)
         else if (retval == 0)
         {
             // Nothing to read, finish process
+            if (tracer != NULL)
+            {
+                destruct_tracer(tracer);
+            }
+            if (recorder != NULL)
+            {
+                destruct_recorder(recorder);
+            }
             return 0;
         }
 
         // printf("NODE %d: Data ready - %d, X - ", node, retval);
 
         // Process all input values, even if we read more than one integer from named pipe
-        for (int i = 0; i < retval / sizeof(int); i++)
-        {
-            int x = buff[i];
-
-            // printf("%d ", x);
+        int count = retval / sizeof(int);
+        int done = 0;
 
-            // calculate
-            value_t result;
+        // Values are taken over from pipe
+        trial_clock_work(1);
+        trial_clock_take(count);
 
-            tf_result_t result_type;
+        while (done < count)
+        {
+            // calculate, whole buffer at once
+            bool timed = tracer != NULL || recorder != NULL;
+            long long begin = timed ? trace_now() : 0;
+            int evaluated = eval(buff + done, count - done, results);
+            long long end = timed ? trace_now() : 0;
 
-            switch (node)
+            for (int i = done; tracer != NULL && i < done + evaluated; i++)
             {
-            case F_NODE:
-                switch (tf)
-                {
-                case TF_IMUL:
-                    result.status = trial_f_imul(x, &result.i_val);
-                    break;
-                case TF_IMIN:
-                    result.status = trial_f_imin(x, &result.ui_val);
-                    break;
-                case TF_FMUL:
-                    result.status = trial_f_fmul(x, &result.d_val);
-                    break;
-                case TF_AND:
-                    result.status = trial_f_and(x, &result.b_val);
-                    break;
-                case TF_OR:
-                    result.status = trial_f_or(x, &result.b_val);
-                    break;
-                }
-                break;
-            case G_NODE:
-                switch (tf)
+                if (trace_sampled(tracer, buff[i]))
                 {
-                case TF_IMUL:
-                    result.status = trial_g_imul(x, &result.i_val);
-                    break;
-                case TF_IMIN:
-                    result.status = trial_g_imin(x, &result.ui_val);
-                    break;
-                case TF_FMUL:
-                    result.status = trial_g_fmul(x, &result.d_val);
-                    break;
-                case TF_AND:
-                    result.status = trial_g_and(x, &result.b_val);
-                    break;
-                case TF_OR:
-                    result.status = trial_g_or(x, &result.b_val);
-                    break;
+                    // Batch is evaluated at once, span covers the whole batch
+                    trace_span(tracer, 0, "eval", buff[i], begin, end);
                 }
-                break;
             }
 
-            // send result
-            int w_result = write(result_fd, &result, sizeof(result));
-            if (w_result == -1 || w_result != sizeof(result))
+            if (recorder != NULL && !record_results(recorder, buff + done, results, evaluated, end - begin))
+            {
+                fprintf(stderr, "NODE %d: Recording write error\n", node);
+                return 1;
+            }
+
+            // send results, single write for the whole batch
+            trial_clock_work(evaluated);
+            int w_result = write(result_fd, results, sizeof(value_t) * evaluated);
+            if (w_result == -1 || w_result != sizeof(value_t) * evaluated)
             {
                 // Error, or data write is incomplete
                 fprintf(stderr, "NODE %d: Data write error (%d)\n", node, w_result);
                 return 1;
             }
+
+            done += evaluated;
         }
 
+        trial_clock_work(-1);
+
         // printf("\n");
     }
 
@@ -0,0 +1,268 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <trialfuncs.h>
+
+#define MAX_DELAY_TENTHS (TRIAL_CASE_HANGS - 1) // The longest delay, which is not a hang
+
+enum _delay_distribution
+{
+    DD_FIXED,   // Always the mean delay
+    DD_UNIFORM, // Uniform in [0, 2 * mean]
+    DD_EXP,     // Exponential, frequent short delays and rare long ones
+    DD_COUNT
+};
+
+typedef enum _delay_distribution delay_distribution_t;
+
+static const char *delay_distribution_names[DD_COUNT] = {
+    [DD_FIXED] = "fixed",
+    [DD_UNIFORM] = "uniform",
+    [DD_EXP] = "exp",
+};
+
+static const char *table_names[TRIAL_CASES_COUNT] = {
+    [TRIAL_CASES_AND] = "and",
+    [TRIAL_CASES_IMUL] = "imul",
+    [TRIAL_CASES_IMIN] = "imin",
+    [TRIAL_CASES_FMUL] = "fmul",
+};
+
+struct _case_spec
+{
+    unsigned int count;                // Number of x values in every generated table
+    delay_distribution_t distribution; // Distribution of delays
+    double mean_delay[2];              // Mean delay of f and g, tenths of second
+    double soft_fail;                  // Probability of soft fail
+    double hard_fail;                  // Probability of hard fail
+    double hang;                       // Probability of endless computation
+};
+
+/// @brief Configuration of generated tables
+typedef struct _case_spec case_spec_t;
+
+static void usage()
+{
+    printf("app usage:  casegen [-c count] [-s seed] [-d distribution] [-f f_delay] [-g g_delay] [-S soft_fail] [-H hard_fail] [-x hang] [-t tables] <cases_file>\n"
+           "  -c  number of x values in table, default 1000000\n"
+           "  -s  seed of random generator, default 25\n"
+           "  -d  distribution of delays - fixed, uniform or exp, default exp\n"
+           "  -f  mean delay of f, tenths of second, default 10\n"
+           "  -g  mean delay of g, tenths of second, default 30\n"
+           "  -S  probability of soft fail, default 0\n"
+           "  -H  probability of hard fail, default 0\n"
+           "  -x  probability of endless computation, default 0\n"
+           "  -t  comma separated tables - and, imul, imin, fmul, default all of them\n"
+           "file is loaded by manager and calculon with -C option\n");
+}
+
+static int generate_delay(const case_spec_t *spec, int node)
+{
+    double mean = spec->mean_delay[node];
+    double delay;
+
+    switch (spec->distribution)
+    {
+    case DD_UNIFORM:
+        delay = drand48() * 2 * mean;
+        break;
+    case DD_EXP:
+        delay = -mean * log(1.0 - drand48());
+        break;
+    case DD_FIXED:
+    default:
+        delay = mean;
+        break;
+    }
+
+    return delay < MAX_DELAY_TENTHS ? (int)(delay + 0.5) : MAX_DELAY_TENTHS;
+}
+
+static void generate_case(const case_spec_t *spec, int table, int node, struct trial_case *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->delay_tenths = generate_delay(spec, node);
+
+    double u = drand48();
+
+    if (u < spec->hang)
+    {
+        c->delay_tenths = TRIAL_CASE_HANGS;
+        c->status = COMPFUNC_HARD_FAIL;
+        return;
+    }
+    else if (u < spec->hang + spec->hard_fail)
+    {
+        c->status = COMPFUNC_HARD_FAIL;
+        return;
+    }
+    else if (u < spec->hang + spec->hard_fail + spec->soft_fail)
+    {
+        c->status = COMPFUNC_SOFT_FAIL;
+        return;
+    }
+
+    c->status = COMPFUNC_SUCCESS;
+
+    switch (table)
+    {
+    case TRIAL_CASES_AND:
+        c->value.b = lrand48() % 2;
+        break;
+    case TRIAL_CASES_IMUL:
+        c->value.i = (int)(lrand48() % 2001) - 1000;
+        break;
+    case TRIAL_CASES_IMIN:
+        c->value.u = lrand48() % 1000;
+        break;
+    case TRIAL_CASES_FMUL:
+        c->value.d = drand48() * 1000 - 500;
+        break;
+    }
+}
+
+/// @brief Parse list of table names
+/// @return False, on unknown name
+static bool parse_tables(char *list, bool *tables)
+{
+    memset(tables, 0, sizeof(bool) * TRIAL_CASES_COUNT);
+
+    for (char *name = strtok(list, ","); name != NULL; name = strtok(NULL, ","))
+    {
+        int i = 0;
+
+        while (i < TRIAL_CASES_COUNT && strcmp(name, table_names[i]) != 0)
+        {
+            i++;
+        }
+
+        if (i == TRIAL_CASES_COUNT)
+        {
+            return false;
+        }
+
+        tables[i] = true;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    case_spec_t spec = {
+        .count = 1000000,
+        .distribution = DD_EXP,
+        .mean_delay = {10, 30},
+        .soft_fail = 0,
+        .hard_fail = 0,
+        .hang = 0,
+    };
+
+    bool tables[TRIAL_CASES_COUNT] = {true, true, true, true};
+    long seed = 25;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:s:d:f:g:S:H:x:t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            spec.count = strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            seed = atol(optarg);
+            break;
+        case 'd':
+            spec.distribution = DD_COUNT;
+            for (int i = 0; i < DD_COUNT; i++)
+            {
+                if (strcmp(optarg, delay_distribution_names[i]) == 0)
+                {
+                    spec.distribution = i;
+                }
+            }
+            break;
+        case 'f':
+            spec.mean_delay[0] = atof(optarg);
+            break;
+        case 'g':
+            spec.mean_delay[1] = atof(optarg);
+            break;
+        case 'S':
+            spec.soft_fail = atof(optarg);
+            break;
+        case 'H':
+            spec.hard_fail = atof(optarg);
+            break;
+        case 'x':
+            spec.hang = atof(optarg);
+            break;
+        case 't':
+            if (!parse_tables(optarg, tables))
+            {
+                printf("Unknown table: %s\n", optarg);
+                usage();
+                return 1;
+            }
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if (argc - optind != 1 || spec.distribution == DD_COUNT || spec.mean_delay[0] < 0 || spec.mean_delay[1] < 0 ||
+        spec.soft_fail + spec.hard_fail + spec.hang > 1)
+    {
+        usage();
+        return 1;
+    }
+
+    FILE *file = fopen(argv[optind], "wb");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "casegen: Failed to create %s\n", argv[optind]);
+        return 1;
+    }
+
+    struct trial_cases_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRIAL_CASES_MAGIC, sizeof(header.magic));
+
+    for (int i = 0; i < TRIAL_CASES_COUNT; i++)
+    {
+        header.count[i] = tables[i] ? spec.count : 0;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    srand48(seed);
+
+    // Tables in order of header, f and g case of every x
+    for (int i = 0; i < TRIAL_CASES_COUNT && written; i++)
+    {
+        for (unsigned int x = 0; x < header.count[i] && written; x++)
+        {
+            struct trial_case cases[2];
+
+            generate_case(&spec, i, 0, &cases[0]);
+            generate_case(&spec, i, 1, &cases[1]);
+
+            written = fwrite(cases, sizeof(cases), 1, file) == 1;
+        }
+    }
+
+    if (fclose(file) != 0 || !written)
+    {
+        fprintf(stderr, "casegen: Failed to write %s\n", argv[optind]);
+        remove(argv[optind]);
+        return 1;
+    }
+
+    return 0;
+}
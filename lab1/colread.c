@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include <compfuncs.h>
+
+#include "columnar.h"
+#include "registry.h"
+#include "shared_data.h"
+
+static void usage()
+{
+    printf("app usage:  colread <results_file> [min_x [max_x]]\n"
+           "  print rows of columnar results file, with x in range, sorted by x within block\n"
+           "  blocks are skipped by x range only if input x is clustered, otherwise each one is searched\n");
+}
+
+static void print_value(tf_result_t type, const value_t *val)
+{
+    printf("%s", symbolic_status(val->status));
+
+    if (val->status == COMPFUNC_SUCCESS)
+    {
+        printf("<");
+        result_types[type].print(val);
+        printf(">");
+    }
+}
+
+static void print_row(void *ctx, int x, const value_t values[COLUMNAR_COLUMNS])
+{
+    const columnar_reader_t *reader = ctx;
+
+    printf("%d", x);
+
+    for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+    {
+        printf(" ");
+        print_value(columnar_type(reader, c), &values[c]);
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 4)
+    {
+        usage();
+        return 1;
+    }
+
+    int min_x = argc > 2 ? atoi(argv[2]) : INT_MIN;
+    int max_x = argc > 3 ? atoi(argv[3]) : (argc > 2 ? min_x : INT_MAX);
+
+    columnar_reader_t *reader = construct_columnar_reader(argv[1]);
+
+    if (reader == NULL)
+    {
+        return 1;
+    }
+
+    long long rows;
+    int blocks = columnar_blocks(reader, &rows);
+
+    fprintf(stderr, "f - %s, g - %s, final - %s, %lld rows in %d blocks\n",
+            columnar_func(reader, 0), columnar_func(reader, 1), columnar_func(reader, 2), rows, blocks);
+
+    int scanned;
+    long long found = columnar_scan(reader, min_x, max_x, print_row, reader, &scanned);
+
+    fprintf(stderr, "%lld rows found, %d blocks scanned\n", found, scanned);
+
+    destruct_columnar_reader(reader);
+
+    return 0;
+}
@@ -0,0 +1,511 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "columnar.h"
+#include "registry.h"
+
+#define COLUMNAR_MAGIC "L125COL2"
+#define COLUMNAR_BLOCK 65536 // Maximal number of rows in block
+
+struct _columnar_header
+{
+    char magic[8];                      // COLUMNAR_MAGIC
+    char funcs[COLUMNAR_COLUMNS][16];   // f(x), g(x) and final operation names
+    uint8_t types[COLUMNAR_COLUMNS];    // tf_result_t of columns
+    uint8_t pad[5];
+};
+
+typedef struct _columnar_header columnar_header_t;
+
+struct _block_index
+{
+    uint64_t offset; // Offset of block in file
+    uint32_t count;  // Number of rows
+    int32_t min_x;   // Minimal x in block
+    int32_t max_x;   // Maximal x in block
+    uint32_t pad;
+};
+
+/// @brief Footer index entry
+typedef struct _block_index block_index_t;
+
+struct _columnar_trailer
+{
+    uint64_t index_offset; // Offset of the first index entry
+    uint32_t blocks;       // Number of blocks
+    uint32_t pad;
+    char magic[8];         // COLUMNAR_MAGIC
+};
+
+typedef struct _columnar_trailer columnar_trailer_t;
+
+struct _columnar_writer
+{
+    int fd;                                      // Output file
+    size_t sizes[COLUMNAR_COLUMNS];              // Value sizes of columns
+    int *x;                                      // x values of current block
+    unsigned char *status[COLUMNAR_COLUMNS];     // Statuses of current block
+    char *data[COLUMNAR_COLUMNS];                // Values of current block
+    uint64_t *keys;                              // Sort keys of rows, x and row index
+    int *sorted_x;                               // Rows of current block sorted by x,
+    unsigned char *sorted_status[COLUMNAR_COLUMNS]; // buffers are swapped with the unsorted ones
+    char *sorted_data[COLUMNAR_COLUMNS];
+    int count;                                   // Number of rows in current block
+    block_index_t *index;                        // Index of written blocks
+    int blocks;                                  // Number of written blocks
+    int index_capacity;                          // Size of index buffer
+    uint64_t offset;                             // File size
+};
+
+struct _columnar_reader
+{
+    const char *map;                      // Mapped file
+    size_t size;                          // File size
+    const columnar_header_t *header;      // File header
+    const block_index_t *index;           // Footer index
+    int blocks;                           // Number of blocks
+    size_t sizes[COLUMNAR_COLUMNS];       // Value sizes of columns
+    char funcs[COLUMNAR_COLUMNS][17];     // Zero terminated names of functions
+};
+
+static void destroy_writer(columnar_writer_t *writer)
+{
+    if (writer->fd != -1)
+    {
+        close(writer->fd);
+    }
+
+    free(writer->x);
+    free(writer->keys);
+    free(writer->sorted_x);
+
+    for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+    {
+        free(writer->status[c]);
+        free(writer->data[c]);
+        free(writer->sorted_status[c]);
+        free(writer->sorted_data[c]);
+    }
+
+    free(writer->index);
+    free(writer);
+}
+
+columnar_writer_t *construct_columnar_writer(const char *path, const char *const funcs[COLUMNAR_COLUMNS], const tf_result_t types[COLUMNAR_COLUMNS])
+{
+    columnar_writer_t *writer = calloc(1, sizeof(columnar_writer_t));
+
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0640);
+    writer->x = malloc(sizeof(int) * COLUMNAR_BLOCK);
+    writer->keys = malloc(sizeof(uint64_t) * COLUMNAR_BLOCK);
+    writer->sorted_x = malloc(sizeof(int) * COLUMNAR_BLOCK);
+
+    bool allocated = writer->fd != -1 && writer->x != NULL && writer->keys != NULL && writer->sorted_x != NULL;
+
+    columnar_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+
+    for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+    {
+        writer->sizes[c] = result_types[types[c]].size;
+        writer->status[c] = malloc(COLUMNAR_BLOCK);
+        writer->data[c] = malloc(writer->sizes[c] * COLUMNAR_BLOCK);
+        writer->sorted_status[c] = malloc(COLUMNAR_BLOCK);
+        writer->sorted_data[c] = malloc(writer->sizes[c] * COLUMNAR_BLOCK);
+        allocated = allocated && writer->status[c] != NULL && writer->data[c] != NULL &&
+                    writer->sorted_status[c] != NULL && writer->sorted_data[c] != NULL;
+
+        strncpy(header.funcs[c], funcs[c], sizeof(header.funcs[c]));
+        header.types[c] = types[c];
+    }
+
+    if (!allocated || write(writer->fd, &header, sizeof(header)) != sizeof(header))
+    {
+        destroy_writer(writer);
+        return NULL;
+    }
+
+    writer->offset = sizeof(header);
+
+    return writer;
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+    uint64_t ka = *(const uint64_t *)a;
+    uint64_t kb = *(const uint64_t *)b;
+
+    return (ka > kb) - (ka < kb);
+}
+
+/// @brief Sort rows of current block by x, rows with the same x keep input order
+static void sort_block(columnar_writer_t *writer)
+{
+    int count = writer->count;
+
+    // Sign bit is flipped, unsigned order of keys is the order of x
+    for (int i = 0; i < count; i++)
+    {
+        writer->keys[i] = (uint64_t)((uint32_t)writer->x[i] ^ 0x80000000u) << 32 | (uint32_t)i;
+    }
+
+    qsort(writer->keys, count, sizeof(uint64_t), compare_keys);
+
+    for (int i = 0; i < count; i++)
+    {
+        int row = (int)(uint32_t)writer->keys[i];
+        writer->sorted_x[i] = writer->x[row];
+    }
+
+    for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+    {
+        size_t size = writer->sizes[c];
+
+        for (int i = 0; i < count; i++)
+        {
+            int row = (int)(uint32_t)writer->keys[i];
+            writer->sorted_status[c][i] = writer->status[c][row];
+            memcpy(writer->sorted_data[c] + size * i, writer->data[c] + size * row, size);
+        }
+    }
+
+    int *x = writer->x;
+    writer->x = writer->sorted_x;
+    writer->sorted_x = x;
+
+    for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+    {
+        unsigned char *status = writer->status[c];
+        char *data = writer->data[c];
+
+        writer->status[c] = writer->sorted_status[c];
+        writer->data[c] = writer->sorted_data[c];
+        writer->sorted_status[c] = status;
+        writer->sorted_data[c] = data;
+    }
+}
+
+/// @brief Write current block as columns sorted by x, add index entry
+static bool flush_block(columnar_writer_t *writer)
+{
+    if (writer->count == 0)
+    {
+        return true;
+    }
+
+    sort_block(writer);
+
+    if (writer->blocks == writer->index_capacity)
+    {
+        int capacity = MAX(64, writer->index_capacity * 2);
+        block_index_t *index = realloc(writer->index, sizeof(block_index_t) * capacity);
+
+        if (index == NULL)
+        {
+            return false;
+        }
+
+        writer->index = index;
+        writer->index_capacity = capacity;
+    }
+
+    block_index_t *entry = &writer->index[writer->blocks];
+    memset(entry, 0, sizeof(*entry));
+    entry->offset = writer->offset;
+    entry->count = writer->count;
+
+    entry->min_x = writer->x[0];
+    entry->max_x = writer->x[writer->count - 1];
+
+    struct iovec iov[1 + 2 * COLUMNAR_COLUMNS];
+    size_t size = sizeof(int) * writer->count;
+
+    iov[0].iov_base = writer->x;
+    iov[0].iov_len = sizeof(int) * writer->count;
+
+    for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+    {
+        iov[1 + 2 * c].iov_base = writer->status[c];
+        iov[1 + 2 * c].iov_len = writer->count;
+        iov[2 + 2 * c].iov_base = writer->data[c];
+        iov[2 + 2 * c].iov_len = writer->sizes[c] * writer->count;
+        size += writer->count + writer->sizes[c] * writer->count;
+    }
+
+    if (writev(writer->fd, iov, 1 + 2 * COLUMNAR_COLUMNS) != (ssize_t)size)
+    {
+        return false;
+    }
+
+    writer->offset += size;
+    writer->blocks++;
+    writer->count = 0;
+
+    return true;
+}
+
+bool columnar_append(columnar_writer_t *writer, const int *x, const value_column_t *const cols[COLUMNAR_COLUMNS], int begin, int count)
+{
+    while (count > 0)
+    {
+        int chunk = MIN(count, COLUMNAR_BLOCK - writer->count);
+
+        memcpy(writer->x + writer->count, x + begin, sizeof(int) * chunk);
+
+        for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+        {
+            memcpy(writer->status[c] + writer->count, cols[c]->status + begin, chunk);
+            memcpy(writer->data[c] + writer->sizes[c] * writer->count, (const char *)cols[c]->data + writer->sizes[c] * begin, writer->sizes[c] * chunk);
+        }
+
+        writer->count += chunk;
+        begin += chunk;
+        count -= chunk;
+
+        if (writer->count == COLUMNAR_BLOCK && !flush_block(writer))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void destruct_columnar_writer(columnar_writer_t *writer)
+{
+    columnar_trailer_t trailer;
+    memset(&trailer, 0, sizeof(trailer));
+
+    bool written = flush_block(writer);
+
+    trailer.index_offset = writer->offset;
+    trailer.blocks = writer->blocks;
+    memcpy(trailer.magic, COLUMNAR_MAGIC, sizeof(trailer.magic));
+
+    ssize_t index_size = sizeof(block_index_t) * writer->blocks;
+
+    written = written && (index_size == 0 || write(writer->fd, writer->index, index_size) == index_size);
+    written = written && write(writer->fd, &trailer, sizeof(trailer)) == sizeof(trailer);
+
+    if (!written)
+    {
+        fprintf(stderr, "columnar: Failed to write results\n");
+    }
+
+    destroy_writer(writer);
+}
+
+columnar_reader_t *construct_columnar_reader(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+
+    if (fd == -1 || fstat(fd, &st) == -1)
+    {
+        fprintf(stderr, "columnar: Failed to open %s\n", path);
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    if (st.st_size < (off_t)(sizeof(columnar_header_t) + sizeof(columnar_trailer_t)))
+    {
+        fprintf(stderr, "columnar: %s is not complete\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    const char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        fprintf(stderr, "columnar: Failed to map %s\n", path);
+        return NULL;
+    }
+
+    const columnar_header_t *header = (const columnar_header_t *)map;
+    const columnar_trailer_t *trailer = (const columnar_trailer_t *)(map + st.st_size - sizeof(columnar_trailer_t));
+
+    // Number of blocks is checked before offsets are summed, they don't overflow
+    uint64_t body_size = st.st_size - sizeof(columnar_header_t) - sizeof(columnar_trailer_t);
+
+    bool valid = memcmp(header->magic, COLUMNAR_MAGIC, sizeof(header->magic)) == 0 &&
+                 memcmp(trailer->magic, COLUMNAR_MAGIC, sizeof(trailer->magic)) == 0 &&
+                 trailer->blocks <= body_size / sizeof(block_index_t) &&
+                 trailer->index_offset >= sizeof(columnar_header_t) &&
+                 trailer->index_offset + sizeof(block_index_t) * trailer->blocks + sizeof(columnar_trailer_t) == (uint64_t)st.st_size;
+
+    size_t row_size = sizeof(int);
+
+    for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+    {
+        valid = valid && header->types[c] < TFR_COUNT;
+        row_size += valid ? 1 + result_types[header->types[c]].size : 0;
+    }
+
+    // Every block should lie between header and index
+    const block_index_t *index = (const block_index_t *)(map + (valid ? trailer->index_offset : 0));
+
+    for (uint32_t b = 0; valid && b < trailer->blocks; b++)
+    {
+        valid = index[b].count <= COLUMNAR_BLOCK &&
+                index[b].offset >= sizeof(columnar_header_t) &&
+                index[b].offset <= trailer->index_offset &&
+                row_size * index[b].count <= trailer->index_offset - index[b].offset;
+    }
+
+    columnar_reader_t *reader = valid ? calloc(1, sizeof(columnar_reader_t)) : NULL;
+
+    if (reader == NULL)
+    {
+        fprintf(stderr, "columnar: %s is not a results file, or it is not complete\n", path);
+        munmap((void *)map, st.st_size);
+        return NULL;
+    }
+
+    reader->map = map;
+    reader->size = st.st_size;
+    reader->header = header;
+    reader->index = index;
+    reader->blocks = trailer->blocks;
+
+    for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+    {
+        reader->sizes[c] = result_types[header->types[c]].size;
+        memcpy(reader->funcs[c], header->funcs[c], sizeof(header->funcs[c]));
+    }
+
+    return reader;
+}
+
+void destruct_columnar_reader(columnar_reader_t *reader)
+{
+    munmap((void *)reader->map, reader->size);
+    free(reader);
+}
+
+const char *columnar_func(const columnar_reader_t *reader, int column)
+{
+    return reader->funcs[column];
+}
+
+tf_result_t columnar_type(const columnar_reader_t *reader, int column)
+{
+    return reader->header->types[column];
+}
+
+int columnar_blocks(const columnar_reader_t *reader, long long *rows)
+{
+    if (rows != NULL)
+    {
+        *rows = 0;
+
+        for (int b = 0; b < reader->blocks; b++)
+        {
+            *rows += reader->index[b].count;
+        }
+    }
+
+    return reader->blocks;
+}
+
+long long columnar_scan(const columnar_reader_t *reader, int min_x, int max_x, columnar_row_func_t visit, void *ctx, int *scanned)
+{
+    long long visited = 0;
+
+    if (scanned != NULL)
+    {
+        *scanned = 0;
+    }
+
+    for (int b = 0; b < reader->blocks; b++)
+    {
+        const block_index_t *entry = &reader->index[b];
+
+        // Skip block without x in range
+        if (entry->max_x < min_x || entry->min_x > max_x)
+        {
+            continue;
+        }
+
+        if (scanned != NULL)
+        {
+            (*scanned)++;
+        }
+
+        const char *x = reader->map + entry->offset;
+        const char *status[COLUMNAR_COLUMNS];
+        const char *data[COLUMNAR_COLUMNS];
+        const char *p = x + sizeof(int) * entry->count;
+
+        for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+        {
+            status[c] = p;
+            data[c] = p + entry->count;
+            p = data[c] + reader->sizes[c] * entry->count;
+        }
+
+        // Rows are sorted by x, the first one in range is found by binary search
+        uint32_t lo = 0;
+        uint32_t hi = entry->count;
+
+        while (lo < hi)
+        {
+            uint32_t mid = lo + (hi - lo) / 2;
+            int xm;
+            memcpy(&xm, x + sizeof(int) * mid, sizeof(int));
+
+            if (xm < min_x)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+
+        for (uint32_t i = lo; i < entry->count; i++)
+        {
+            int xi;
+            memcpy(&xi, x + sizeof(int) * i, sizeof(int));
+
+            if (xi > max_x)
+            {
+                break;
+            }
+
+            value_t values[COLUMNAR_COLUMNS];
+            memset(values, 0, sizeof(values));
+
+            for (int c = 0; c < COLUMNAR_COLUMNS; c++)
+            {
+                // Payload members of value_t share the same address
+                values[c].status = (unsigned char)status[c][i];
+                memcpy(&values[c].i_val, data[c] + reader->sizes[c] * i, reader->sizes[c]);
+            }
+
+            visit(ctx, xi, values);
+            visited++;
+        }
+    }
+
+    return visited;
+}
@@ -0,0 +1,87 @@
+#ifndef __COLUMNAR_INC__
+#define __COLUMNAR_INC__
+
+#include <stdbool.h>
+
+#include "result_store.h"
+#include "shared_data.h"
+
+/// @brief Number of columns besides x: f(x), g(x) and final result
+#define COLUMNAR_COLUMNS 3
+
+/// @brief Indexed columnar binary file of results.
+///
+/// File consists of header, blocks and footer index. Block keeps up to COLUMNAR_BLOCK rows
+/// as columns: x values, then status bytes and values of f(x), g(x) and final result.
+/// Rows of block are sorted by x, rows with the same x keep input order.
+/// Footer index keeps offset, number of rows and min/max of x for every block,
+/// so reader maps the file, skips blocks which don't overlap with x range and
+/// binary searches x in the others. Blocks are cut in input order, they are
+/// skipped only if input x is clustered, otherwise every block is searched.
+typedef struct _columnar_writer columnar_writer_t;
+
+/// @brief Reader of columnar file
+typedef struct _columnar_reader columnar_reader_t;
+
+/// @brief Called for each row in x range
+/// @param ctx    User data
+/// @param x      Input value
+/// @param values Values of f(x), g(x) and final result
+typedef void (*columnar_row_func_t)(void *ctx, int x, const value_t values[COLUMNAR_COLUMNS]);
+
+/// @brief Create file, write header
+/// @param path  File name
+/// @param funcs Names of f(x), g(x) and final operation
+/// @param types Types of f(x), g(x) and final result
+/// @return Writer instance, NULL on failure
+columnar_writer_t *construct_columnar_writer(const char *path, const char *const funcs[COLUMNAR_COLUMNS], const tf_result_t types[COLUMNAR_COLUMNS]);
+
+/// @brief Write the last block and index, close file
+/// @param writer Writer allocated by construct_columnar_writer()
+void destruct_columnar_writer(columnar_writer_t *writer);
+
+/// @brief Append range of rows
+/// @param writer Writer
+/// @param x      Input values
+/// @param cols   Columns of f(x), g(x) and final result, types are given to construct_columnar_writer()
+/// @param begin  Index of the first row
+/// @param count  Number of rows
+/// @return True, on success
+bool columnar_append(columnar_writer_t *writer, const int *x, const value_column_t *const cols[COLUMNAR_COLUMNS], int begin, int count);
+
+/// @brief Map file, validate header and index
+/// @param path File name
+/// @return Reader instance, NULL on failure
+columnar_reader_t *construct_columnar_reader(const char *path);
+
+/// @brief Unmap file
+/// @param reader Reader allocated by construct_columnar_reader()
+void destruct_columnar_reader(columnar_reader_t *reader);
+
+/// @brief Names of f(x), g(x) and final operation
+/// @param reader Reader
+/// @param column Column index, 0 - f(x), 1 - g(x), 2 - final result
+const char *columnar_func(const columnar_reader_t *reader, int column);
+
+/// @brief Type of column
+/// @param reader Reader
+/// @param column Column index, 0 - f(x), 1 - g(x), 2 - final result
+tf_result_t columnar_type(const columnar_reader_t *reader, int column);
+
+/// @brief Number of blocks and rows
+/// @param reader Reader
+/// @param rows   Number of rows, could be NULL
+/// @return Number of blocks
+int columnar_blocks(const columnar_reader_t *reader, long long *rows);
+
+/// @brief Visit rows with x in range, blocks in file order, rows of block in order of x
+/// @param reader  Reader
+/// @param min_x   Minimal x
+/// @param max_x   Maximal x
+/// @param visit   Row callback
+/// @param ctx     User data for callback
+/// @param scanned Number of blocks which overlap with range, could be NULL
+/// @return Number of visited rows
+long long columnar_scan(const columnar_reader_t *reader, int min_x, int max_x, columnar_row_func_t visit, void *ctx, int *scanned);
+
+#endif // __COLUMNAR_INC__
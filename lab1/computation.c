@@ -0,0 +1,122 @@
+#include <memory.h>
+
+#include "computation.h"
+
+bool final_stage_init(final_stage_t *stage, const trial_function_t *funcs, int count, const value_column_t results[NODES_COUNT], int capacity)
+{
+    bool allocated = true;
+
+    memset(stage, 0, sizeof(final_stage_t));
+    stage->count = count;
+
+    for (int k = 0; k < count; k++)
+    {
+        stage->function[k] = funcs[k];
+        stage->type[k] = trial_result_type(funcs[k]);
+        stage->op[k] = trial_ops[funcs[k]].final;
+        allocated = allocated && column_init(&stage->results[k], stage->type[k], capacity);
+    }
+
+    // Operations of the same type share casted operands
+    for (int i = 0; i < NODES_COUNT; i++)
+    {
+        for (int k = 0; k < count; k++)
+        {
+            tf_result_t t = stage->type[k];
+
+            if (stage->arg[i][t] != NULL)
+            {
+                continue;
+            }
+
+            if (results[i].type != t)
+            {
+                allocated = allocated && column_init(&stage->args[i][t], t, capacity);
+                stage->arg[i][t] = &stage->args[i][t];
+                stage->cast[i][t] = column_casts[results[i].type][t];
+            }
+            else
+            {
+                stage->arg[i][t] = &results[i];
+            }
+        }
+    }
+
+    return allocated;
+}
+
+void final_stage_free(final_stage_t *stage)
+{
+    for (int i = 0; i < NODES_COUNT; i++)
+    {
+        for (tf_result_t t = 0; t < TFR_COUNT; t++)
+        {
+            column_free(&stage->args[i][t]);
+        }
+    }
+
+    for (int k = 0; k < stage->count; k++)
+    {
+        column_free(&stage->results[k]);
+    }
+}
+
+void final_stage_run(final_stage_t *stage, const value_column_t results[NODES_COUNT], int begin, int count)
+{
+    // Each cast once per target type, shared by operations of the type
+    for (int i = 0; i < NODES_COUNT; i++)
+    {
+        for (tf_result_t t = 0; t < TFR_COUNT; t++)
+        {
+            if (stage->cast[i][t] != NULL)
+            {
+                stage->cast[i][t](&results[i], &stage->args[i][t], begin, count);
+            }
+        }
+    }
+
+    for (int k = 0; k < stage->count; k++)
+    {
+        tf_result_t t = stage->type[k];
+        stage->op[k](stage->arg[F_NODE][t], stage->arg[G_NODE][t], &stage->results[k], begin, count);
+    }
+}
+
+int queue_free_end(int head_pos, int free_pos, int capacity)
+{
+    return head_pos > free_pos ? head_pos - 1 : capacity - (head_pos == 0);
+}
+
+int queue_ready_end(calculated_value_t *const calc_state[NODES_COUNT], int current_pos, int free_pos, int capacity)
+{
+    while (current_pos != free_pos)
+    {
+        for (int i = 0; i < NODES_COUNT; i++)
+        {
+            if (calc_state[i][current_pos].comm != CS_RECEIVED)
+            {
+                // Not all data available
+                return current_pos;
+            }
+        }
+
+        current_pos = (current_pos + 1) % capacity;
+    }
+
+    return current_pos;
+}
+
+bool receive_result(calculated_value_t *state, value_column_t *col, int pos, const value_t *val, bool retry)
+{
+    state->comm = CS_RECEIVED;
+    result_types[col->type].store(col, pos, val);
+
+    if (val->status == COMPFUNC_SOFT_FAIL && state->soft_retry < MAX_SOFT_RETRY && retry)
+    {
+        state->soft_retry++;
+        state->comm = CS_NONE;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,59 @@
+#ifndef __COMPUTATION_INC__
+#define __COMPUTATION_INC__
+
+#include <stdbool.h>
+
+#include "registry.h"
+#include "result_store.h"
+#include "shared_data.h"
+
+// Steps of circular computation queue, shared by manager and daemon sessions
+
+struct _final_stage
+{
+    int count;                                         // Number of final operations
+    trial_function_t function[TF_COUNT];               // Final operations
+    tf_result_t type[TF_COUNT];                        // Final operations value types
+    final_op_func_t op[TF_COUNT];                      // Final operation kernels
+    value_column_t results[TF_COUNT];                  // Results of final operations, in queue order
+    value_column_t args[NODES_COUNT][TFR_COUNT];       // f(x) and g(x) casted to types of final operations, if types differ
+    const value_column_t *arg[NODES_COUNT][TFR_COUNT]; // Operands of final operations by type, NULL if type is not used
+    column_cast_func_t cast[NODES_COUNT][TFR_COUNT];   // Cast to final type, once for all operations of the type, NULL if not required
+};
+
+/// @brief Final operations over f(x) and g(x) columns
+typedef struct _final_stage final_stage_t;
+
+/// @brief Allocate columns of final results and casted operands
+/// @param stage    Final stage
+/// @param funcs    Final operations
+/// @param count    Number of final operations
+/// @param results  Columns of f(x) and g(x), they are operands of the same type
+/// @param capacity Size of queue
+/// @return True, on success. Stage is released by final_stage_free() in any case
+bool final_stage_init(final_stage_t *stage, const trial_function_t *funcs, int count, const value_column_t results[NODES_COUNT], int capacity);
+
+/// @brief Release columns of final stage
+void final_stage_free(final_stage_t *stage);
+
+/// @brief Apply final operations to range of values with both results
+void final_stage_run(final_stage_t *stage, const value_column_t results[NODES_COUNT], int begin, int count);
+
+/// @brief Contiguous free space of circular queue, one element is kept empty to distinguish full queue
+/// @return End of free range, which starts at free_pos
+int queue_free_end(int head_pos, int free_pos, int capacity);
+
+/// @brief Advance over values with both results available
+/// @return Index of the first value waiting for results
+int queue_ready_end(calculated_value_t *const calc_state[NODES_COUNT], int current_pos, int free_pos, int capacity);
+
+/// @brief Store received result of node, soft fail is scheduled for retry while retries are left
+/// @param state Communication state of value
+/// @param col   Results of node
+/// @param pos   Position of value in queue
+/// @param val   Received result
+/// @param retry Retry is allowed
+/// @return True, if value is scheduled for retry, its state is CS_NONE then
+bool receive_result(calculated_value_t *state, value_column_t *col, int pos, const value_t *val, bool retry);
+
+#endif // __COMPUTATION_INC__
@@ -0,0 +1,539 @@
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/param.h>
+#include <sys/select.h>
+
+#include "backlog.h"
+#include "input_parser.h"
+#include "shared_data.h"
+
+#define DEFAULT_SHARDS 4
+#define SHARD_INPUT_LIMIT (1 << 20)   // Bytes of input values, waiting for transmission to shard
+#define SHARD_OUTPUT_LIMIT (16 << 20) // Bytes of shard output, waiting for merge
+#define COORD_READ_BUFF 65536         // Buffer for reading input and shard output
+#define COORD_CHUNK 1024              // Values taken from input backlog at once
+#define FINAL_PREFIX "Final expression for "
+
+const char *manager_task = "manager";
+
+struct _shard
+{
+    pid_t pid;           // Manager process
+    int in_fd;           // Input values of manager, -1 when closed
+    int out_fd;          // Output of manager, -1 at the end of output
+    char *in;            // Raw int32 input values, not sent yet
+    size_t in_pos;       // Sent part of input values
+    size_t in_len;       // Length of input values
+    char *out;           // Output of manager, not merged yet
+    size_t out_pos;      // Merged part of output
+    size_t out_len;      // Length of output
+    size_t out_capacity; // Size of output buffer
+};
+
+/// @brief Manager instance, with its own calculon workers
+typedef struct _shard shard_t;
+
+struct _coordinator
+{
+    shard_t *shards;         // Manager instances
+    int count;               // Number of shards
+    input_parser_t *parser;  // Tokenizer of input stream
+    backlog_t *input;        // Input values, waiting for shard
+    backlog_t *order;        // Shard of each value, in input order
+    bool input_eof;          // Input stream is finished
+    int carry[COORD_CHUNK];  // Values taken from backlog, not queued to shard yet
+    int carry_pos;           // Index of the first carried value
+    int carry_count;         // Number of carried values
+    int next_shard;          // Shard of the next merged result, -1 if not known yet
+    char *read_buff;         // Buffer for reading
+};
+
+/// @brief Coordinator of shards
+typedef struct _coordinator coordinator_t;
+
+static void usage()
+{
+    printf("app usage:  coordinator [-p shards] [-n queue_size] <f_function> <g_function> <final_operation>\n"
+           "  -p  number of manager instances, default %d\n"
+           "  -n  number of values in computation of each instance\n"
+           "input values are partitioned by hash of x, final results are printed in input order\n",
+           DEFAULT_SHARDS);
+}
+
+/// @brief Shard of value, the same x is always calculated by the same shard
+static int shard_of(const coordinator_t *crd, int x)
+{
+    uint32_t hash = (uint32_t)x * 2654435761u;
+    return (int)((hash ^ (hash >> 16)) % (uint32_t)crd->count);
+}
+
+static bool start_shard(shard_t *shard, char **args)
+{
+    int in_pipe[2];
+    int out_pipe[2];
+
+    if (pipe(in_pipe) == -1 || pipe(out_pipe) == -1)
+    {
+        return false;
+    }
+
+    // Managers should not inherit pipes of other shards
+    for (int i = 0; i < 2; i++)
+    {
+        fcntl(in_pipe[i], F_SETFD, FD_CLOEXEC);
+        fcntl(out_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, in_pipe[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+
+    // Keyboard interrupt is delivered to coordinator only
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attr, 0);
+
+    int status = posix_spawn(&shard->pid, manager_task, &actions, &attr, args, NULL);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+
+    if (status != 0)
+    {
+        close(in_pipe[1]);
+        close(out_pipe[0]);
+        return false;
+    }
+
+    shard->in_fd = in_pipe[1];
+    shard->out_fd = out_pipe[0];
+    fcntl(shard->in_fd, F_SETFL, O_NONBLOCK);
+
+    shard->in = malloc(SHARD_INPUT_LIMIT);
+
+    return shard->in != NULL && shard->in_fd < FD_SETSIZE && shard->out_fd < FD_SETSIZE;
+}
+
+/// @brief Queue input values to shards, stop at the first value for full shard
+/// @return False, if order of values is not queued
+static bool distribute(coordinator_t *crd)
+{
+    while (true)
+    {
+        if (crd->carry_pos == crd->carry_count)
+        {
+            crd->carry_pos = 0;
+            crd->carry_count = backlog_pop(crd->input, crd->carry, COORD_CHUNK);
+
+            if (crd->carry_count == 0)
+            {
+                return true;
+            }
+        }
+
+        int order[COORD_CHUNK];
+        int count = 0;
+
+        while (crd->carry_pos < crd->carry_count)
+        {
+            int x = crd->carry[crd->carry_pos];
+            shard_t *shard = &crd->shards[shard_of(crd, x)];
+
+            if (shard->in_len + sizeof(int) > SHARD_INPUT_LIMIT)
+            {
+                if (shard->in_pos == 0)
+                {
+                    break;
+                }
+
+                // Drop sent part
+                memmove(shard->in, shard->in + shard->in_pos, shard->in_len - shard->in_pos);
+                shard->in_len -= shard->in_pos;
+                shard->in_pos = 0;
+            }
+
+            memcpy(shard->in + shard->in_len, &x, sizeof(int));
+            shard->in_len += sizeof(int);
+            order[count++] = shard_of(crd, x);
+            crd->carry_pos++;
+        }
+
+        if (!backlog_push(crd->order, order, count))
+        {
+            fprintf(stderr, "coordinator: Backlog is out of memory\n");
+            return false;
+        }
+
+        if (crd->carry_pos < crd->carry_count)
+        {
+            // Shard is full
+            return true;
+        }
+    }
+}
+
+/// @brief Print results in input order, while they are available
+/// @return False, if shard finished without result
+static bool merge(coordinator_t *crd)
+{
+    while (true)
+    {
+        if (crd->next_shard == -1 && backlog_pop(crd->order, &crd->next_shard, 1) == 0)
+        {
+            crd->next_shard = -1;
+            return true;
+        }
+
+        shard_t *shard = &crd->shards[crd->next_shard];
+        bool found = false;
+
+        while (!found)
+        {
+            char *line = shard->out + shard->out_pos;
+            char *eol = memchr(line, '\n', shard->out_len - shard->out_pos);
+
+            if (eol == NULL)
+            {
+                if (shard->out_fd == -1)
+                {
+                    fprintf(stderr, "coordinator: Shard %d finished without result\n", crd->next_shard);
+                    return false;
+                }
+                return true;
+            }
+
+            shard->out_pos = eol + 1 - shard->out;
+
+            // Other lines of manager are not results
+            if (strncmp(line, FINAL_PREFIX, strlen(FINAL_PREFIX)) == 0)
+            {
+                fwrite(line, 1, eol + 1 - line, stdout);
+                found = true;
+            }
+        }
+
+        crd->next_shard = -1;
+    }
+}
+
+static bool read_shard(shard_t *shard)
+{
+    if (shard->out_pos > 0)
+    {
+        memmove(shard->out, shard->out + shard->out_pos, shard->out_len - shard->out_pos);
+        shard->out_len -= shard->out_pos;
+        shard->out_pos = 0;
+    }
+
+    if (shard->out_capacity - shard->out_len < COORD_READ_BUFF)
+    {
+        size_t capacity = MAX(2 * shard->out_capacity, 4 * COORD_READ_BUFF);
+        char *out = realloc(shard->out, capacity);
+
+        if (out == NULL)
+        {
+            return false;
+        }
+
+        shard->out = out;
+        shard->out_capacity = capacity;
+    }
+
+    ssize_t result = read(shard->out_fd, shard->out + shard->out_len, shard->out_capacity - shard->out_len);
+
+    if (result > 0)
+    {
+        shard->out_len += result;
+    }
+    else if (result == 0 || (errno != EINTR && errno != EAGAIN))
+    {
+        close(shard->out_fd);
+        shard->out_fd = -1;
+    }
+
+    return true;
+}
+
+static bool write_shard(shard_t *shard)
+{
+    ssize_t result = write(shard->in_fd, shard->in + shard->in_pos, shard->in_len - shard->in_pos);
+
+    if (result == -1)
+    {
+        return errno == EINTR || errno == EAGAIN;
+    }
+
+    shard->in_pos += result;
+
+    if (shard->in_pos == shard->in_len)
+    {
+        shard->in_pos = 0;
+        shard->in_len = 0;
+    }
+
+    return true;
+}
+
+/// @brief Single iteration of event loop
+/// @return False on failure
+static bool coordinate(coordinator_t *crd)
+{
+    if (!distribute(crd))
+    {
+        return false;
+    }
+
+    bool drained = crd->input_eof && backlog_size(crd->input) == 0 && crd->carry_pos == crd->carry_count;
+
+    fd_set data_streams;
+    fd_set out_streams;
+    int nfds = -1;
+
+    FD_ZERO(&data_streams);
+    FD_ZERO(&out_streams);
+
+    // Input waits in pipe, while the first value is not queued to shard
+    if (!crd->input_eof && backlog_size(crd->input) < COORD_CHUNK)
+    {
+        FD_SET(STDIN_FILENO, &data_streams);
+        nfds = STDIN_FILENO;
+    }
+
+    for (int i = 0; i < crd->count; i++)
+    {
+        shard_t *shard = &crd->shards[i];
+
+        if (shard->in_fd != -1 && shard->in_pos < shard->in_len)
+        {
+            FD_SET(shard->in_fd, &out_streams);
+            nfds = MAX(nfds, shard->in_fd);
+        }
+        else if (shard->in_fd != -1 && drained)
+        {
+            // All values are sent, manager finishes at the end of input
+            close(shard->in_fd);
+            shard->in_fd = -1;
+        }
+
+        if (shard->out_fd != -1 && shard->out_len - shard->out_pos < SHARD_OUTPUT_LIMIT)
+        {
+            FD_SET(shard->out_fd, &data_streams);
+            nfds = MAX(nfds, shard->out_fd);
+        }
+    }
+
+    if (nfds == -1)
+    {
+        return true;
+    }
+
+    int sel_result = select(nfds + 1, &data_streams, &out_streams, NULL, NULL);
+
+    if (sel_result == -1)
+    {
+        return errno == EINTR;
+    }
+
+    if (FD_ISSET(STDIN_FILENO, &data_streams))
+    {
+        ssize_t result = read(STDIN_FILENO, crd->read_buff, COORD_READ_BUFF);
+        bool parsed = true;
+
+        if (result > 0)
+        {
+            parsed = input_parse(crd->parser, crd->read_buff, result, crd->input);
+        }
+        else if (result == 0 || (errno != EINTR && errno != EAGAIN))
+        {
+            crd->input_eof = true;
+            parsed = input_finish(crd->parser, crd->input);
+        }
+
+        if (!parsed)
+        {
+            fprintf(stderr, "coordinator: Backlog is out of memory\n");
+            return false;
+        }
+    }
+
+    for (int i = 0; i < crd->count; i++)
+    {
+        shard_t *shard = &crd->shards[i];
+
+        if (shard->out_fd != -1 && FD_ISSET(shard->out_fd, &data_streams) && !read_shard(shard))
+        {
+            return false;
+        }
+
+        if (shard->in_fd != -1 && FD_ISSET(shard->in_fd, &out_streams) && !write_shard(shard))
+        {
+            fprintf(stderr, "coordinator: Shard %d input failed (%d)\n", i, errno);
+            return false;
+        }
+    }
+
+    return merge(crd);
+}
+
+static bool coordinator_finished(const coordinator_t *crd)
+{
+    if (!crd->input_eof || backlog_size(crd->order) > 0 || crd->next_shard != -1)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < crd->count; i++)
+    {
+        if (crd->shards[i].out_fd != -1)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int shards = DEFAULT_SHARDS;
+    const char *queue_size = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            shards = atoi(optarg);
+            break;
+        case 'n':
+            queue_size = optarg;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if (argc - optind != 3 || shards < 1)
+    {
+        usage();
+        return 1;
+    }
+
+    for (int i = optind; i < argc; i++)
+    {
+        if (function_from_name(argv[i]) == TF_UNKNOWN)
+        {
+            printf("Unsupported function/operation: %d - %s\n", i - optind + 1, argv[i]);
+            return 1;
+        }
+    }
+
+    // Shard failure is detected by write error
+    signal(SIGPIPE, SIG_IGN);
+
+    coordinator_t crd;
+    memset(&crd, 0, sizeof(crd));
+
+    crd.count = shards;
+    crd.next_shard = -1;
+    crd.shards = calloc(shards, sizeof(shard_t));
+    crd.parser = construct_input_parser(false);
+    crd.input = construct_backlog(65536, 1 << 20, NULL);
+    crd.order = construct_backlog(65536, 1 << 20, NULL);
+    crd.read_buff = malloc(COORD_READ_BUFF);
+
+    if (crd.shards == NULL || crd.parser == NULL || crd.input == NULL || crd.order == NULL || crd.read_buff == NULL)
+    {
+        fprintf(stderr, "coordinator: Allocation failed\n");
+        return 1;
+    }
+
+    // Managers read raw int32 values, print only final results
+    char *args[16];
+    int n = 0;
+
+    args[n++] = (char *)manager_task;
+    args[n++] = "-b";
+    args[n++] = "-q";
+    if (queue_size != NULL)
+    {
+        args[n++] = "-n";
+        args[n++] = (char *)queue_size;
+    }
+    args[n++] = argv[optind];
+    args[n++] = argv[optind + 1];
+    args[n++] = argv[optind + 2];
+    args[n] = NULL;
+
+    int status = 0;
+
+    for (int i = 0; i < shards; i++)
+    {
+        crd.shards[i].in_fd = -1;
+        crd.shards[i].out_fd = -1;
+
+        if (!start_shard(&crd.shards[i], args))
+        {
+            fprintf(stderr, "coordinator: Failed to start shard %d\n", i);
+            status = 1;
+            break;
+        }
+    }
+
+    while (status == 0 && !coordinator_finished(&crd))
+    {
+        if (!coordinate(&crd))
+        {
+            status = 1;
+        }
+    }
+
+    fflush(stdout);
+
+    // Stop managers
+    for (int i = 0; i < shards; i++)
+    {
+        shard_t *shard = &crd.shards[i];
+
+        if (shard->in_fd != -1)
+        {
+            close(shard->in_fd);
+        }
+
+        if (shard->out_fd != -1)
+        {
+            close(shard->out_fd);
+        }
+
+        if (shard->pid > 0)
+        {
+            waitpid(shard->pid, NULL, 0);
+        }
+
+        free(shard->in);
+        free(shard->out);
+    }
+
+    destruct_input_parser(crd.parser);
+    destruct_backlog(crd.input);
+    destruct_backlog(crd.order);
+    free(crd.read_buff);
+    free(crd.shards);
+
+    return status;
+}
@@ -0,0 +1,360 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/param.h>
+
+#include "input_parser.h"
+
+#define OUT_BUFF 1024 // Values collected before push to backlog
+#define MAX_TOKEN 32  // Longest carried text token
+
+struct _input_parser
+{
+    bool binary;             // Raw int32 input
+    char partial[MAX_TOKEN]; // Incomplete value from previous chunk
+    int partial_len;         // Length of incomplete value
+    bool skip_line;          // Rest of malformed line is not received yet
+    int out[OUT_BUFF];       // Parsed values
+    int out_count;           // Number of parsed values in out
+    long long parsed;        // Number of parsed values
+    long long errors;        // Number of malformed values
+};
+
+input_parser_t *construct_input_parser(bool binary)
+{
+    input_parser_t *parser = calloc(1, sizeof(input_parser_t));
+
+    if (parser != NULL)
+    {
+        parser->binary = binary;
+    }
+
+    return parser;
+}
+
+void destruct_input_parser(input_parser_t *parser)
+{
+    free(parser);
+}
+
+static bool flush_values(input_parser_t *parser, backlog_t *dst)
+{
+    bool result = backlog_push(dst, parser->out, parser->out_count);
+    parser->parsed += parser->out_count;
+    parser->out_count = 0;
+    return result;
+}
+
+static bool emit_value(input_parser_t *parser, int value, backlog_t *dst)
+{
+    parser->out[parser->out_count++] = value;
+
+    if (parser->out_count == OUT_BUFF)
+    {
+        return flush_values(parser, dst);
+    }
+
+    return true;
+}
+
+static inline bool is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+/// @brief Number of leading digits in 8 characters, SIMD within a register
+static inline int count_digits8(uint64_t chars)
+{
+    // Each byte is 0x33 only for '0'..'9', carry propagates towards later characters only
+    uint64_t test = (chars & 0xF0F0F0F0F0F0F0F0ULL) | (((chars + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4);
+    uint64_t mismatch = test ^ 0x3333333333333333ULL;
+
+    return mismatch == 0 ? 8 : __builtin_ctzll(mismatch) / 8;
+}
+
+/// @brief Convert 8 digits, the first character is the most significant digit
+static inline uint32_t parse_digits8(uint64_t chars)
+{
+    chars = ((chars & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    chars = ((chars & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return (uint32_t)(((chars & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+}
+
+#define SWAR_PARSER 1
+
+#endif
+
+/// @brief Parse decimal integer
+/// @return Pointer after the last digit, NULL if there are no digits or value is out of int range
+static const char *parse_int(const char *p, const char *end, int *value)
+{
+    bool negative = false;
+
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+
+    const char *digits = p;
+    long long acc = 0;
+
+#ifdef SWAR_PARSER
+    // Fast path, up to 8 digits at once, while there is no risk to read past the end
+    if (end - p >= 8)
+    {
+        uint64_t chars;
+        memcpy(&chars, p, sizeof(chars));
+
+        int n = count_digits8(chars);
+        if (n > 0)
+        {
+            // Drop characters after digits, leading zero bytes are equal to '0' digits
+            acc = parse_digits8(chars << (8 * (8 - n)));
+            p += n;
+        }
+
+        if (n < 8)
+        {
+            goto done;
+        }
+    }
+#endif
+
+    while (p < end && *p >= '0' && *p <= '9' && p - digits < 11)
+    {
+        acc = acc * 10 + (*p - '0');
+        p++;
+    }
+
+#ifdef SWAR_PARSER
+done:
+#endif
+    if (p == digits || acc > (negative ? -(long long)INT_MIN : INT_MAX))
+    {
+        return NULL;
+    }
+
+    *value = (int)(negative ? -acc : acc);
+
+    return p;
+}
+
+static void report_error(input_parser_t *parser, const char *token, size_t len)
+{
+    parser->errors++;
+    fprintf(stderr, "Failed to parse input - %.*s\n", (int)MIN(len, 64), token);
+}
+
+/// @brief Parse single token, which is known to be complete
+static bool parse_token(input_parser_t *parser, const char *token, size_t len, backlog_t *dst)
+{
+    int value;
+    const char *after = parse_int(token, token + len, &value);
+
+    if (after != token + len)
+    {
+        report_error(parser, token, len);
+        return true;
+    }
+
+    return emit_value(parser, value, dst);
+}
+
+static bool parse_binary(input_parser_t *parser, const char *data, size_t len, backlog_t *dst)
+{
+    // Complete value, split between chunks
+    if (parser->partial_len > 0)
+    {
+        size_t n = MIN(len, sizeof(int) - parser->partial_len);
+        memcpy(parser->partial + parser->partial_len, data, n);
+        parser->partial_len += n;
+        data += n;
+        len -= n;
+
+        if (parser->partial_len < sizeof(int))
+        {
+            return true;
+        }
+
+        int value;
+        memcpy(&value, parser->partial, sizeof(int));
+        parser->partial_len = 0;
+
+        if (!emit_value(parser, value, dst))
+        {
+            return false;
+        }
+    }
+
+    size_t count = len / sizeof(int);
+
+    while (count > 0)
+    {
+        size_t chunk = MIN(count, OUT_BUFF - parser->out_count);
+        memcpy(parser->out + parser->out_count, data, sizeof(int) * chunk);
+        parser->out_count += chunk;
+        data += sizeof(int) * chunk;
+        count -= chunk;
+
+        if (parser->out_count == OUT_BUFF && !flush_values(parser, dst))
+        {
+            return false;
+        }
+    }
+
+    parser->partial_len = len % sizeof(int);
+    memcpy(parser->partial, data, parser->partial_len);
+
+    return flush_values(parser, dst);
+}
+
+bool input_parse(input_parser_t *parser, const char *data, size_t len, backlog_t *dst)
+{
+    if (parser->binary)
+    {
+        return parse_binary(parser, data, len, dst);
+    }
+
+    const char *p = data;
+    const char *end = data + len;
+
+    if (parser->skip_line)
+    {
+        p = memchr(p, '\n', end - p);
+        if (p == NULL)
+        {
+            return true;
+        }
+        parser->skip_line = false;
+    }
+
+    // Complete token, split between chunks
+    if (parser->partial_len > 0)
+    {
+        while (p < end && !is_space(*p) && parser->partial_len < MAX_TOKEN)
+        {
+            parser->partial[parser->partial_len++] = *p++;
+        }
+
+        if (p == end)
+        {
+            // Still incomplete
+            return true;
+        }
+
+        if (parser->partial_len == MAX_TOKEN)
+        {
+            report_error(parser, parser->partial, parser->partial_len);
+            parser->partial_len = 0;
+            parser->skip_line = true;
+            return input_parse(parser, p, end - p, dst);
+        }
+
+        if (!parse_token(parser, parser->partial, parser->partial_len, dst))
+        {
+            return false;
+        }
+        parser->partial_len = 0;
+    }
+
+    while (p < end)
+    {
+        while (p < end && is_space(*p))
+        {
+            p++;
+        }
+
+        if (p == end)
+        {
+            break;
+        }
+
+        int value;
+        const char *after = parse_int(p, end, &value);
+
+        if (after == NULL || after == end || !is_space(*after))
+        {
+            const char *token_end = p;
+            while (token_end < end && !is_space(*token_end))
+            {
+                token_end++;
+            }
+
+            if (token_end == end)
+            {
+                // Token may continue in the next chunk
+                break;
+            }
+
+            // Malformed line, skip it
+            const char *eol = memchr(p, '\n', end - p);
+            report_error(parser, p, (eol ? eol : end) - p);
+            if (eol == NULL)
+            {
+                parser->skip_line = true;
+                p = end;
+                break;
+            }
+            p = eol;
+            continue;
+        }
+
+        if (!emit_value(parser, value, dst))
+        {
+            return false;
+        }
+
+        p = after;
+    }
+
+    // Carry the last token
+    if (p < end)
+    {
+        if (end - p >= MAX_TOKEN)
+        {
+            report_error(parser, p, end - p);
+            parser->skip_line = true;
+        }
+        else
+        {
+            memcpy(parser->partial, p, end - p);
+            parser->partial_len = end - p;
+        }
+    }
+
+    return flush_values(parser, dst);
+}
+
+bool input_finish(input_parser_t *parser, backlog_t *dst)
+{
+    if (parser->partial_len > 0)
+    {
+        if (parser->binary)
+        {
+            report_error(parser, "incomplete int32 value", 22);
+        }
+        else if (!parse_token(parser, parser->partial, parser->partial_len, dst))
+        {
+            return false;
+        }
+
+        parser->partial_len = 0;
+    }
+
+    return flush_values(parser, dst);
+}
+
+long long input_parsed(const input_parser_t *parser)
+{
+    return parser->parsed;
+}
+
+long long input_errors(const input_parser_t *parser)
+{
+    return parser->errors;
+}
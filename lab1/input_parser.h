@@ -0,0 +1,47 @@
+#ifndef __INPUT_PARSER_INC__
+#define __INPUT_PARSER_INC__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "backlog.h"
+
+/// @brief Streaming tokenizer of input values.
+///
+/// Text input is a sequence of decimal integers separated by white space, one per line usually.
+/// Binary input is a sequence of native int32 values. Value split between chunks is carried
+/// to the next chunk.
+typedef struct _input_parser input_parser_t;
+
+/// @brief Create parser
+/// @param binary True for raw int32 input, false for text
+/// @return Parser instance, NULL on failure
+input_parser_t *construct_input_parser(bool binary);
+
+/// @brief Release parser
+/// @param parser Parser allocated by construct_input_parser()
+void destruct_input_parser(input_parser_t *parser);
+
+/// @brief Parse chunk of input stream, append values to backlog
+/// @param parser Parser
+/// @param data   Chunk of input stream
+/// @param len    Chunk length
+/// @param dst    Destination for parsed values
+/// @return True, on success. Malformed values are reported and skipped
+bool input_parse(input_parser_t *parser, const char *data, size_t len, backlog_t *dst);
+
+/// @brief End of input stream, flush carried value
+/// @param parser Parser
+/// @param dst    Destination for parsed value
+/// @return True, on success
+bool input_finish(input_parser_t *parser, backlog_t *dst);
+
+/// @brief Number of parsed values
+/// @param parser Parser
+long long input_parsed(const input_parser_t *parser);
+
+/// @brief Number of malformed values
+/// @param parser Parser
+long long input_errors(const input_parser_t *parser);
+
+#endif // __INPUT_PARSER_INC__
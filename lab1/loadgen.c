@@ -0,0 +1,709 @@
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/param.h>
+#include <sys/select.h>
+#include <time.h>
+
+#include <trialfuncs.h>
+
+#include "metrics.h"
+#include "shared_data.h"
+
+#define LOADGEN_READ_BUFF 65536 // Buffer for manager output
+#define LOADGEN_WRITE_MAX 4096  // Values written at once
+#define RECENT_VALUES 1024      // Window of generated values, source of repetitions
+#define FINAL_PREFIX "Final expression for "
+#define FAULTS_MAX 1024         // Length of fault injection of single run
+#define STATS_PATH_MAX 64       // Length of path of manager metrics
+
+enum _distribution
+{
+    XD_UNIFORM, // Uniform in [-range, range]
+    XD_ZIPF,    // Zipf-like, small absolute values are frequent
+    XD_ZERO,    // Always 0, the only value with successful results in every trial function
+    XD_COUNT
+};
+
+typedef enum _distribution distribution_t;
+
+static const char *distribution_names[XD_COUNT] = {
+    [XD_UNIFORM] = "uniform",
+    [XD_ZIPF] = "zipf",
+    [XD_ZERO] = "zero",
+};
+
+struct _load_spec
+{
+    long long count;             // Number of generated values
+    double rate;                 // Values per second, 0 for unlimited
+    int burst;                   // Values sent together
+    double repeat;               // Probability of repeating one of recent values
+    distribution_t distribution; // Distribution of new values
+    int range;                   // Range of new values
+    const char *queue_size;      // Queue size of manager, NULL for default
+    long long timeout;           // Limit of single run, microseconds, 0 for unlimited
+    const char *faults;          // Fault injection of trial functions, NULL to disable
+    const char *cases_file;      // Case tables of trial functions, NULL for compiled cases
+    const char *clock_file;      // Virtual clock, shared with manager, NULL for real time
+};
+
+/// @brief Configuration of generated input stream
+typedef struct _load_spec load_spec_t;
+
+struct _load_run
+{
+    const load_spec_t *spec;        // Input stream configuration
+    pid_t pid;                      // Manager process, leader of its process group
+    int in_fd;                      // Input of manager, -1 when closed
+    int out_fd;                     // Output of manager, -1 at the end of output
+    long long *sent_at;             // Scheduled time of each value with rate, otherwise its transmission time
+    long long generated;            // Number of generated values
+    long long sent;                 // Number of values written to manager
+    long long received;             // Number of final results
+    int pending[LOADGEN_WRITE_MAX]; // Generated values, not written yet
+    int pending_count;              // Number of generated values, not written yet
+    size_t pending_pos;             // Written bytes of generated values
+    int recent[RECENT_VALUES];      // Recently generated values
+    char *out;                      // Prefix of incomplete output line
+    size_t out_len;                 // Length of line prefix
+    long long started;              // Start of transmission, microseconds
+    long long deadline;             // End of timeout, microseconds of real time
+    histogram_t latency;            // Time from transmission to final result, microseconds
+    char stats_path[STATS_PATH_MAX]; // Metrics of manager, written at its exit
+    long long evaluations;          // Results of f and g, including failed ones
+    long long retries;              // Soft fails of f and g, retried by manager
+    long long hard_fails;           // Hard fails of f and g
+    long long final_fails;          // Values with failed final result
+};
+
+/// @brief Single measured run of manager
+typedef struct _load_run load_run_t;
+
+/// @brief Real time for timeout, the other time values are simulated with virtual clock
+static long long real_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static void usage()
+{
+    printf("app usage:  loadgen [-c count] [-r rate] [-B burst] [-p repeat] [-d distribution] [-R range] [-n queue_size] [-T timeout] [-F faults] [-E rates] [-C cases_file] [-V clock_file] (-a | <f_function> <g_function> <final_operation>)\n"
+           "  -c  number of values, default 1000\n"
+           "  -r  values per second, default 0 - as fast as manager accepts them\n"
+           "  -B  values sent together, at the same rate, default 1\n"
+           "  -p  probability of repeating one of recent values, 0 - 1, default 0\n"
+           "  -d  distribution of new values - uniform, zipf or zero, default uniform\n"
+           "  -R  range of new values, default 100\n"
+           "  -n  queue size of manager\n"
+           "  -T  limit of single run in seconds, manager and workers are killed after it\n"
+           "  -F  inject faults to trial functions, see manager\n"
+           "  -E  comma separated soft fail rates, run for each of them, added to -F faults\n"
+           "  -C  case tables of trial functions, see casegen\n"
+           "  -V  virtual clock, latency and throughput in simulated time, rate is not supported\n"
+           "  -a  run every combination of functions and operation\n"
+           "manager is started from the current directory, report is printed as JSON line per run\n");
+}
+
+static int generate_value(load_run_t *run)
+{
+    const load_spec_t *spec = run->spec;
+    int x;
+
+    if (run->generated > 0 && drand48() < spec->repeat)
+    {
+        x = run->recent[lrand48() % MIN(run->generated, RECENT_VALUES)];
+    }
+    else
+    {
+        switch (spec->distribution)
+        {
+        case XD_ZIPF:
+        {
+            // Inverse transform of continuous power law, rounded to integer
+            double u = drand48();
+            int magnitude = (int)(pow(spec->range + 1.0, u)) - 1;
+            x = lrand48() % 2 ? magnitude : -magnitude;
+            break;
+        }
+        case XD_ZERO:
+            x = 0;
+            break;
+        case XD_UNIFORM:
+        default:
+            x = (int)(lrand48() % (2 * spec->range + 1)) - spec->range;
+            break;
+        }
+    }
+
+    run->recent[run->generated % RECENT_VALUES] = x;
+    run->generated++;
+
+    return x;
+}
+
+/// @brief Generate values allowed by rate, when previous ones are written
+static void generate(load_run_t *run, long long now)
+{
+    const load_spec_t *spec = run->spec;
+
+    if (run->pending_count > 0 || run->generated == spec->count)
+    {
+        return;
+    }
+
+    long long allowed = spec->count;
+
+    if (spec->rate > 0)
+    {
+        // Whole bursts, the first one is sent immediately
+        long long bursts = (long long)((now - run->started) * spec->rate / 1e6 / spec->burst) + 1;
+        allowed = MIN(allowed, bursts * spec->burst);
+    }
+
+    int count = MIN(allowed - run->generated, LOADGEN_WRITE_MAX);
+
+    for (int i = 0; i < count; i++)
+    {
+        run->pending[i] = generate_value(run);
+    }
+
+    run->pending_count = MAX(count, 0);
+    run->pending_pos = 0;
+}
+
+/// @brief Time, when burst of the value is due with rate
+static long long scheduled_at(const load_run_t *run, long long value)
+{
+    const load_spec_t *spec = run->spec;
+    long long burst_index = value / spec->burst;
+
+    return run->started + (long long)(burst_index * spec->burst * 1e6 / spec->rate);
+}
+
+/// @return Microseconds until the next burst, -1 if there is nothing to wait for
+static long long next_burst(const load_run_t *run, long long now)
+{
+    const load_spec_t *spec = run->spec;
+
+    if (spec->rate <= 0 || run->pending_count > 0 || run->generated == spec->count)
+    {
+        return -1;
+    }
+
+    return MAX(scheduled_at(run, run->generated) - now, 0);
+}
+
+static bool write_values(load_run_t *run)
+{
+    size_t total = sizeof(int) * run->pending_count;
+    ssize_t result = write(run->in_fd, (char *)run->pending + run->pending_pos, total - run->pending_pos);
+
+    if (result == -1)
+    {
+        return errno == EINTR || errno == EAGAIN;
+    }
+
+    long long now = metrics_now();
+    long long first = run->sent;
+
+    run->pending_pos += result;
+    run->sent = run->generated - run->pending_count + run->pending_pos / sizeof(int);
+
+    // Value held back by backpressure of manager waits since it is due,
+    // latency includes the wait, otherwise queueing time is omitted
+    for (long long i = first; i < run->sent; i++)
+    {
+        run->sent_at[i] = run->spec->rate > 0 ? scheduled_at(run, i) : now;
+    }
+
+    if (run->pending_pos == total)
+    {
+        run->pending_count = 0;
+    }
+
+    return true;
+}
+
+static bool read_results(load_run_t *run)
+{
+    char buff[LOADGEN_READ_BUFF];
+    ssize_t result = read(run->out_fd, buff, sizeof(buff));
+
+    if (result == 0 || (result == -1 && errno != EINTR && errno != EAGAIN))
+    {
+        close(run->out_fd);
+        run->out_fd = -1;
+        return true;
+    }
+    else if (result == -1)
+    {
+        return true;
+    }
+
+    long long now = metrics_now();
+
+    for (ssize_t i = 0; i < result; i++)
+    {
+        if (buff[i] != '\n')
+        {
+            // Only prefix of line is needed
+            if (run->out_len < strlen(FINAL_PREFIX))
+            {
+                run->out[run->out_len++] = buff[i];
+            }
+            continue;
+        }
+
+        if (run->out_len == strlen(FINAL_PREFIX) && memcmp(run->out, FINAL_PREFIX, run->out_len) == 0)
+        {
+            // Results are printed in input order
+            if (run->received >= run->sent)
+            {
+                fprintf(stderr, "loadgen: Unexpected result\n");
+                return false;
+            }
+
+            histogram_record(&run->latency, now - run->sent_at[run->received]);
+            run->received++;
+        }
+
+        run->out_len = 0;
+    }
+
+    return true;
+}
+
+static bool start_manager(load_run_t *run, char **funcs)
+{
+    int in_pipe[2];
+    int out_pipe[2];
+
+    if (pipe(in_pipe) == -1 || pipe(out_pipe) == -1)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        fcntl(in_pipe[i], F_SETFD, FD_CLOEXEC);
+        fcntl(out_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    char *args[20];
+    int n = 0;
+
+    // Counters of retries and fails, injected faults are seen by their realised rate
+    snprintf(run->stats_path, sizeof(run->stats_path), "loadgen_%d.stats", (int)getpid());
+
+    args[n++] = "manager";
+    args[n++] = "-b";
+    args[n++] = "-q";
+    args[n++] = "-S";
+    args[n++] = run->stats_path;
+    if (run->spec->queue_size != NULL)
+    {
+        args[n++] = "-n";
+        args[n++] = (char *)run->spec->queue_size;
+    }
+    if (run->spec->faults != NULL)
+    {
+        args[n++] = "-F";
+        args[n++] = (char *)run->spec->faults;
+    }
+    if (run->spec->cases_file != NULL)
+    {
+        args[n++] = "-C";
+        args[n++] = (char *)run->spec->cases_file;
+    }
+    if (run->spec->clock_file != NULL)
+    {
+        // Clock is created by load generator, manager shares it
+        args[n++] = "-V";
+        args[n++] = (char *)run->spec->clock_file;
+    }
+    args[n++] = funcs[0];
+    args[n++] = funcs[1];
+    args[n++] = funcs[2];
+    args[n] = NULL;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, in_pipe[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+
+    // Process group of manager and its workers, killed together on timeout
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attr, 0);
+
+    int status = posix_spawn(&run->pid, args[0], &actions, &attr, args, NULL);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+
+    if (status != 0)
+    {
+        close(in_pipe[1]);
+        close(out_pipe[0]);
+        return false;
+    }
+
+    run->in_fd = in_pipe[1];
+    run->out_fd = out_pipe[0];
+    fcntl(run->in_fd, F_SETFL, O_NONBLOCK);
+
+    return run->in_fd < FD_SETSIZE && run->out_fd < FD_SETSIZE;
+}
+
+/// @brief Feed manager, wait for all results
+/// @return False on failure
+static bool run_load(load_run_t *run)
+{
+    run->started = metrics_now();
+    run->deadline = real_now() + run->spec->timeout;
+
+    while (run->out_fd != -1)
+    {
+        long long now = metrics_now();
+
+        generate(run, now);
+
+        if (run->in_fd != -1 && run->pending_count == 0 && run->generated == run->spec->count)
+        {
+            // Manager finishes at the end of input
+            close(run->in_fd);
+            run->in_fd = -1;
+        }
+
+        fd_set data_streams;
+        fd_set out_streams;
+        int nfds = run->out_fd;
+
+        FD_ZERO(&data_streams);
+        FD_ZERO(&out_streams);
+        FD_SET(run->out_fd, &data_streams);
+
+        if (run->in_fd != -1 && run->pending_count > 0)
+        {
+            FD_SET(run->in_fd, &out_streams);
+            nfds = MAX(nfds, run->in_fd);
+        }
+
+        long long wait = next_burst(run, now);
+        struct timeval io_timeout;
+
+        if (run->spec->timeout > 0)
+        {
+            long long left = run->deadline - real_now();
+
+            if (left <= 0)
+            {
+                fprintf(stderr, "loadgen: Timeout, %lld results of %lld values\n", run->received, run->spec->count);
+                kill(-run->pid, SIGKILL);
+
+                // Named pipes of killed manager, suffixed by its pid
+                for (int i = 0; i < NODES_COUNT; i++)
+                {
+                    for (int j = 0; j < 2; j++)
+                    {
+                        char path[256];
+                        snprintf(path, sizeof(path), "%s_%d", node_pipe[i][j], run->pid);
+                        remove(path);
+                    }
+                }
+                if (run->spec->clock_file != NULL)
+                {
+                    remove(run->spec->clock_file);
+                }
+                return false;
+            }
+
+            wait = wait >= 0 ? MIN(wait, left) : left;
+        }
+
+        io_timeout.tv_sec = wait / 1000000;
+        io_timeout.tv_usec = wait % 1000000;
+
+        int sel_result = select(nfds + 1, &data_streams, &out_streams, NULL, wait >= 0 ? &io_timeout : NULL);
+
+        if (sel_result == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        if (FD_ISSET(run->out_fd, &data_streams) && !read_results(run))
+        {
+            return false;
+        }
+
+        if (run->in_fd != -1 && FD_ISSET(run->in_fd, &out_streams) && !write_values(run))
+        {
+            fprintf(stderr, "loadgen: Manager input failed (%d)\n", errno);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// @brief Read counters of retries and fails from metrics of manager, remove the file
+static void read_counters(load_run_t *run)
+{
+    FILE *stream = fopen(run->stats_path, "r");
+
+    if (stream != NULL)
+    {
+        char line[256];
+
+        while (fgets(line, sizeof(line), stream) != NULL)
+        {
+            char node;
+            long long sent, results, retries, hard_fails, finals, final_fails;
+
+            if (sscanf(line, "node %c sent %lld results %lld retries %lld hard_fails %lld", &node, &sent, &results, &retries, &hard_fails) == 5)
+            {
+                run->evaluations += results;
+                run->retries += retries;
+                run->hard_fails += hard_fails;
+            }
+            else if (sscanf(line, "final count %lld failed %lld", &finals, &final_fails) == 2)
+            {
+                run->final_fails = final_fails;
+            }
+        }
+
+        fclose(stream);
+        remove(run->stats_path);
+    }
+}
+
+static bool measure(const load_spec_t *spec, char **funcs)
+{
+    load_run_t *run = calloc(1, sizeof(load_run_t));
+
+    if (run == NULL)
+    {
+        return false;
+    }
+
+    run->spec = spec;
+    run->in_fd = -1;
+    run->out_fd = -1;
+    run->sent_at = malloc(sizeof(run->sent_at[0]) * MAX(spec->count, 1));
+    run->out = malloc(strlen(FINAL_PREFIX));
+
+    srand48(25);
+
+    // Simulated time of the run starts from zero
+    bool clock_ready = spec->clock_file == NULL || trial_clock_create(spec->clock_file) == 0;
+
+    if (!clock_ready)
+    {
+        fprintf(stderr, "loadgen: Failed to create virtual clock %s\n", spec->clock_file);
+    }
+
+    bool success = clock_ready && run->sent_at != NULL && run->out != NULL && start_manager(run, funcs) && run_load(run);
+    long long elapsed = metrics_now() - run->started;
+
+    if (run->in_fd != -1)
+    {
+        close(run->in_fd);
+    }
+
+    if (run->out_fd != -1)
+    {
+        close(run->out_fd);
+    }
+
+    if (run->pid > 0)
+    {
+        waitpid(run->pid, NULL, 0);
+        read_counters(run);
+    }
+
+    if (success && run->received != spec->count)
+    {
+        fprintf(stderr, "loadgen: %lld results of %lld values\n", run->received, spec->count);
+        success = false;
+    }
+
+    printf("{\"f\":\"%s\",\"g\":\"%s\",\"final\":\"%s\",\"faults\":\"%s\",\"values\":%lld,\"results\":%lld,\"elapsed_ms\":%.3f,\"throughput\":%.1f,"
+           "\"latency_us\":{\"mean\":%lld,\"p50\":%lld,\"p90\":%lld,\"p99\":%lld,\"p999\":%lld,\"max\":%lld},"
+           "\"evaluations\":%lld,\"retries\":%lld,\"retry_rate\":%.4f,\"hard_fails\":%lld,\"final_fails\":%lld,\"success\":%s}\n",
+           funcs[0], funcs[1], funcs[2], spec->faults != NULL ? spec->faults : "", spec->count, run->received, elapsed / 1000.0,
+           elapsed > 0 ? run->received * 1e6 / elapsed : 0.0,
+           run->latency.count > 0 ? run->latency.sum / run->latency.count : 0,
+           histogram_percentile(&run->latency, 50), histogram_percentile(&run->latency, 90),
+           histogram_percentile(&run->latency, 99), histogram_percentile(&run->latency, 99.9),
+           run->latency.max, run->evaluations, run->retries, run->evaluations > 0 ? (double)run->retries / run->evaluations : 0.0,
+           run->hard_fails, run->final_fails, success ? "true" : "false");
+    fflush(stdout);
+
+    free(run->sent_at);
+    free(run->out);
+    free(run);
+
+    return success;
+}
+
+/// @brief Measure single combination of functions, or every one
+static bool measure_combinations(const load_spec_t *spec, bool all, char **funcs)
+{
+    if (!all)
+    {
+        return measure(spec, funcs);
+    }
+
+    bool success = true;
+
+    // The same input stream for every combination
+    for (trial_function_t f = 0; f < TF_COUNT; f++)
+    {
+        for (trial_function_t g = 0; g < TF_COUNT; g++)
+        {
+            for (trial_function_t final = 0; final < TF_COUNT; final++)
+            {
+                char *names[3] = {(char *)tf_name(f), (char *)tf_name(g), (char *)tf_name(final)};
+                success = measure(spec, names) && success;
+            }
+        }
+    }
+
+    return success;
+}
+
+int main(int argc, char **argv)
+{
+    load_spec_t spec = {
+        .count = 1000,
+        .rate = 0,
+        .burst = 1,
+        .repeat = 0,
+        .distribution = XD_UNIFORM,
+        .range = 100,
+        .queue_size = NULL,
+        .timeout = 0,
+        .faults = NULL,
+        .cases_file = NULL,
+        .clock_file = NULL,
+    };
+
+    bool all = false;
+    char *rates = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:r:B:p:d:R:n:T:F:E:C:V:a")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            spec.count = atoll(optarg);
+            break;
+        case 'r':
+            spec.rate = atof(optarg);
+            break;
+        case 'B':
+            spec.burst = atoi(optarg);
+            break;
+        case 'p':
+            spec.repeat = atof(optarg);
+            break;
+        case 'd':
+            spec.distribution = XD_COUNT;
+            for (int i = 0; i < XD_COUNT; i++)
+            {
+                if (strcmp(optarg, distribution_names[i]) == 0)
+                {
+                    spec.distribution = i;
+                }
+            }
+            break;
+        case 'R':
+            spec.range = atoi(optarg);
+            break;
+        case 'n':
+            spec.queue_size = optarg;
+            break;
+        case 'T':
+            spec.timeout = (long long)(atof(optarg) * 1e6);
+            break;
+        case 'F':
+            spec.faults = optarg;
+            break;
+        case 'E':
+            rates = optarg;
+            break;
+        case 'C':
+            spec.cases_file = optarg;
+            break;
+        case 'V':
+            spec.clock_file = optarg;
+            break;
+        case 'a':
+            all = true;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if ((all ? argc != optind : argc - optind != 3) || spec.count < 0 || spec.burst < 1 || spec.range < 0 || spec.distribution == XD_COUNT ||
+        (spec.clock_file != NULL && spec.rate > 0))
+    {
+        usage();
+        return 1;
+    }
+
+    // Manager failure is detected by write error
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!all)
+    {
+        for (int i = optind; i < argc; i++)
+        {
+            if (function_from_name(argv[i]) == TF_UNKNOWN)
+            {
+                printf("Unsupported function/operation: %d - %s\n", i - optind + 1, argv[i]);
+                return 1;
+            }
+        }
+    }
+
+    if (rates == NULL)
+    {
+        return measure_combinations(&spec, all, argv + optind) ? 0 : 1;
+    }
+
+    // Failure rate scenario, soft fails exercise retries of manager
+    const char *base_faults = spec.faults;
+    char faults[FAULTS_MAX];
+    bool success = true;
+
+    for (char *rate = strtok(rates, ","); rate != NULL; rate = strtok(NULL, ","))
+    {
+        snprintf(faults, sizeof(faults), "%s%ssoft=%s", base_faults != NULL ? base_faults : "", base_faults != NULL ? ";" : "", rate);
+        spec.faults = faults;
+        success = measure_combinations(&spec, all, argv + optind) && success;
+    }
+
+    return success ? 0 : 1;
+}
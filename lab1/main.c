@@ -1,114 +1,357 @@
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <signal.h>
-#include <sys/select.h>
+#include <sys/signalfd.h>
 #include <unistd.h>
 
 #include "manager.h"
+#include "server.h"
 #include "shared_data.h"
 
 const int COMM_BUFFER = 100;
+const long long BACKLOG_LIMIT = 1 << 20;
 
+// Daemon mode only, manager handles signals through signalfd
 volatile sig_atomic_t cultural_canceling = 0;
 
+// Self-pipe of signals, if signalfd is not available
+static int signal_pipe[2] = {-1, -1};
+
 void handle_interrupt()
 {
     cultural_canceling = 1;
 }
 
-int main(int argc, char **argv)
+/// @brief Pass signal to event loop as signalfd record, select() of the loop wakes up
+static void forward_signal(int signo)
 {
-    printf("OS Lab 1\n");
+    struct signalfd_siginfo info;
+    int saved_errno = errno;
+
+    memset(&info, 0, sizeof(info));
+    info.ssi_signo = signo;
 
-    if (argc != 4)
+    // Record is shorter than PIPE_BUF, it is written whole or dropped, if pipe is full
+    if (write(signal_pipe[1], &info, sizeof(info)) == -1)
     {
-        printf("app usage:  manager <f_function> <g_function> <final_operation>\n"
-        "supported functions and operation: imul, imin, fmul, and, or\n" );
-        return 1;
+        // Nothing to do in handler
     }
 
-    // Validate function names
-    for (int i = 1; i < argc; i++)
+    errno = saved_errno;
+}
+
+static void usage()
+{
+    printf("app usage:  manager -D socket_path\n"
+           "            manager [-n queue_size] [-m backlog_limit] [-s spill_dir] [-i input_file] [-b] [-l log_file [-r]] [-w window] [-o results_file] [-f format] [-q] [-S stats_file] [-t trace_file[:sample]] [-W record_prefix | -P replay_prefix[:timed]] [-V clock_file] [-C cases_file] [-F faults] <f_function> <g_function> <final_operations>\n"
+           "  -n  number of values in computation, default %d\n"
+           "  -m  number of waiting input values kept in memory, default %lld\n"
+           "  -s  directory for waiting input values over backlog limit\n"
+           "  -i  read input values from file, instead of standard input\n"
+           "  -b  input is a sequence of raw int32 values\n"
+           "  -l  log input values and results to file\n"
+           "  -r  resume from log, the same input is expected\n"
+           "  -w  print only window summaries of final results, count:<size>[:<slide>] or time:<ms>[:<slide_ms>]\n"
+           "  -o  write results to indexed columnar binary file, see colread\n"
+           "  -D  daemon mode, serve clients over Unix domain socket, see README.md\n"
+           "  -f  output format - text, csv or json, default text\n"
+           "  -q  don't print results of f and g, only final results\n"
+           "  -S  rewrite metrics to file every second, SIGUSR1 prints them to stderr\n"
+           "  -t  write Chrome trace of value lifecycle, one of <sample> values by hash of x\n"
+           "  -W  record results of f and g to <prefix>.f and <prefix>.g\n"
+           "  -P  replay recorded results instead of calculation, at full speed or with recorded timing\n"
+           "  -V  virtual clock, delays of trial functions advance simulated time shared through file\n"
+           "  -C  case tables of trial functions, generated by casegen\n"
+           "  -F  inject faults to trial functions, [<target>:]<key>=<value>,... entries separated by ;\n"
+           "      target - f, g, operation or f_<operation>, keys - soft, hard, hang, spike, spike_delay, seed\n"
+           "final operations - one or several, separated by comma, e.g. imul,fmul,and\n"
+           "supported functions and operation:",
+           COMM_BUFFER, BACKLOG_LIMIT);
+    for (trial_function_t i = 0; i < TF_COUNT; i++)
     {
-        if (function_from_name(argv[i]) == TF_UNKNOWN)
-        {
-            printf("Unsupported function/operation: %d - %s\n", i, argv[i]);
-            return 1;
-        }
+        printf(" %s", tf_name(i));
     }
+    printf("\n");
+}
 
+/// @brief Serve clients until interrupted, cancellation is not confirmed in daemon mode
+static int run_daemon(const char *socket_path)
+{
     signal(SIGINT, handle_interrupt);
+    signal(SIGTERM, handle_interrupt);
+    // Exited worker or client is reported by write error
+    signal(SIGPIPE, SIG_IGN);
 
-    manager_state_t *mgr = construct_manager(STDIN_FILENO, COMM_BUFFER, argv[1], argv[2], argv[3]);
+    server_t *srv = construct_server(socket_path);
 
-    if (mgr == NULL)
+    if (srv == NULL)
     {
-        fprintf(stderr, "Something goes wrong\n");
         return 1;
     }
 
-    while (1)
+    while (!cultural_canceling)
     {
-        // Handle cancellation signal
-        if (cultural_canceling)
+        if (!serve(srv))
         {
-            cultural_canceling = false;
+            fprintf(stderr, "server: failure in communication\n");
+            break;
+        }
+    }
 
-            bool canceling_confirmed = false;
+    destruct_server(srv);
 
-            printf("Please confirm that computation should be stopped y(es, stop)/n(ot yet)[n]\n");
+    return 0;
+}
 
-            fd_set input_streams;
+int main(int argc, char **argv)
+{
+    printf("OS Lab 1\n");
 
-            FD_ZERO(&input_streams);
+    manager_options_t opts = {
+        .input_fd = STDIN_FILENO,
+        .buffer_size = COMM_BUFFER,
+        .backlog_limit = BACKLOG_LIMIT,
+        .spill_dir = NULL,
+        .input_file = NULL,
+        .binary_input = false,
+        .log_file = NULL,
+        .resume = false,
+        .window = NULL,
+        .columnar_file = NULL,
+        .output_format = OF_TEXT,
+        .quiet = false,
+        .stats_file = NULL,
+        .trace_file = NULL,
+        .trace_sample = 1,
+        .record_prefix = NULL,
+        .replay_prefix = NULL,
+        .replay_timed = false,
+        .virtual_clock = NULL,
+        .cases_file = NULL,
+        .faults = NULL,
+        .signal_fd = -1,
+    };
 
-            FD_SET(STDIN_FILENO, &input_streams);
+    window_spec_t window;
+    const char *socket_path = NULL;
 
-            struct timeval io_timeout;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:m:s:i:bl:rw:o:f:qS:t:W:P:V:C:F:D:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            opts.buffer_size = atoi(optarg);
+            break;
+        case 'm':
+            opts.backlog_limit = atoll(optarg);
+            break;
+        case 's':
+            opts.spill_dir = optarg;
+            break;
+        case 'i':
+            opts.input_file = optarg;
+            break;
+        case 'b':
+            opts.binary_input = true;
+            break;
+        case 'l':
+            opts.log_file = optarg;
+            break;
+        case 'r':
+            opts.resume = true;
+            break;
+        case 'w':
+            if (!parse_window_spec(optarg, &window))
+            {
+                printf("Invalid window: %s\n", optarg);
+                usage();
+                return 1;
+            }
+            opts.window = &window;
+            break;
+        case 'o':
+            opts.columnar_file = optarg;
+            break;
+        case 'f':
+            if (!parse_output_format(optarg, &opts.output_format))
+            {
+                printf("Unsupported output format: %s\n", optarg);
+                usage();
+                return 1;
+            }
+            break;
+        case 'q':
+            opts.quiet = true;
+            break;
+        case 'S':
+            opts.stats_file = optarg;
+            break;
+        case 't':
+        {
+            char *sample = strrchr(optarg, ':');
+            if (sample != NULL)
+            {
+                *sample = '\0';
+                opts.trace_sample = atoi(sample + 1);
+            }
+            opts.trace_file = optarg;
+            break;
+        }
+        case 'W':
+            opts.record_prefix = optarg;
+            break;
+        case 'P':
+        {
+            char *mode = strrchr(optarg, ':');
+            if (mode != NULL && strcmp(mode, ":timed") == 0)
+            {
+                *mode = '\0';
+                opts.replay_timed = true;
+            }
+            opts.replay_prefix = optarg;
+            break;
+        }
+        case 'V':
+            opts.virtual_clock = optarg;
+            break;
+        case 'C':
+            opts.cases_file = optarg;
+            break;
+        case 'F':
+            opts.faults = optarg;
+            break;
+        case 'D':
+            socket_path = optarg;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
 
-            io_timeout.tv_sec = 5;
-            io_timeout.tv_usec = 0;
+    if (socket_path != NULL && argc == optind)
+    {
+        return run_daemon(socket_path);
+    }
 
-            int sel_result = select(1, &input_streams, NULL, NULL, &io_timeout);
+    if (argc - optind != 3 || opts.buffer_size < 2 || (opts.resume && opts.log_file == NULL) || opts.trace_sample < 1 || (opts.record_prefix != NULL && opts.replay_prefix != NULL))
+    {
+        usage();
+        return 1;
+    }
 
-            if (sel_result == 1)
-            {
-                char buff[50];
+    // Validate function names, the last argument is list of operations
+    for (int i = optind; i < argc - 1; i++)
+    {
+        if (function_from_name(argv[i]) == TF_UNKNOWN)
+        {
+            printf("Unsupported function/operation: %d - %s\n", i - optind + 1, argv[i]);
+            return 1;
+        }
+    }
 
-                int retval = read(STDIN_FILENO, buff, sizeof(buff));
+    trial_function_t final_funcs[TF_COUNT];
+    int final_count = functions_from_list(argv[argc - 1], final_funcs);
 
-                if (retval == 2)
-                {
-                    if (buff[0] == 'y' || buff[0] == 'Y')
-                    {
-                        canceling_confirmed = true;
-                    }
-                }
-            }
+    if (final_count == 0)
+    {
+        printf("Unsupported function/operation: 3 - %s\n", argv[argc - 1]);
+        return 1;
+    }
 
-            if (!canceling_confirmed)
-            {
-                printf("action is not confirmed within 5 seconds. proceeding...\n");
-            }
-            else
+    // Window summaries and columnar file hold the single final column
+    if (final_count > 1 && (opts.window != NULL || opts.columnar_file != NULL))
+    {
+        printf("Several final operations are not supported with -w and -o\n");
+        return 1;
+    }
+
+    opts.f_func = argv[optind];
+    opts.g_func = argv[optind + 1];
+    opts.final_func = argv[optind + 2];
+
+    // Signals are handled in event loop of manager, it keeps processing during confirmation
+    sigset_t handled;
+
+    sigemptyset(&handled);
+    sigaddset(&handled, SIGINT);
+    sigaddset(&handled, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &handled, NULL);
+
+    opts.signal_fd = signalfd(-1, &handled, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    if (opts.signal_fd == -1)
+    {
+        fprintf(stderr, "manager: signalfd failed (%d), falling back to signal handlers\n", errno);
+
+        // Handlers write records to pipe, event loop selects on it like on signalfd
+        if (pipe(signal_pipe) == 0)
+        {
+            for (int i = 0; i < 2; i++)
             {
-                shutdown(mgr);
-                communicate(mgr);
-                final_calculation(mgr);
-                break;
+                fcntl(signal_pipe[i], F_SETFD, FD_CLOEXEC);
+                fcntl(signal_pipe[i], F_SETFL, O_NONBLOCK);
             }
+
+            signal(SIGINT, forward_signal);
+            signal(SIGUSR1, forward_signal);
+            opts.signal_fd = signal_pipe[0];
         }
 
+        // Default action of signals, if pipe failed too
+        sigprocmask(SIG_UNBLOCK, &handled, NULL);
+    }
+
+    manager_state_t *mgr = construct_manager(&opts);
+
+    if (mgr == NULL)
+    {
+        fprintf(stderr, "Something goes wrong\n");
+        return 1;
+    }
+
+    int status = 0;
+
+    while (1)
+    {
         if (!communicate(mgr))
         {
             fprintf(stderr, "mgr: failure in communication\n");
+            status = 1;
             break;
         }
 
-        final_calculation(mgr);
+        if (!final_calculation(mgr))
+        {
+            fprintf(stderr, "mgr: failure in final calculation\n");
+            status = 1;
+            break;
+        }
+
+        if (manager_cancel_confirmed(mgr))
+        {
+            shutdown(mgr);
+            communicate(mgr);
+            status = final_calculation(mgr) ? 0 : 1;
+            break;
+        }
+
+        if (manager_finished(mgr))
+        {
+            // All input values are processed
+            break;
+        }
     }
 
     // perform cleanup...
-    destruct_manager(mgr);
+    if (!destruct_manager(mgr))
+    {
+        status = 1;
+    }
 
-    return 0;
+    return status;
 }
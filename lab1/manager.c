@@ -4,116 +4,495 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/select.h>
+#include <sys/signalfd.h>
+#include <signal.h>
 #include <stdio.h>
+#include <time.h>
 #include <errno.h>
 #include <spawn.h>
 #include <sys/param.h>
+#include <sys/mman.h>
 #include <memory.h>
+#include <limits.h>
 
 #include <compfuncs.h>
 #include <trialfuncs.h>
 
+#include "aggregate.h"
+#include "backlog.h"
+#include "columnar.h"
+#include "computation.h"
+#include "input_parser.h"
 #include "manager.h"
+#include "metrics.h"
+#include "output.h"
+#include "record.h"
+#include "registry.h"
+#include "result_log.h"
+#include "result_store.h"
 #include "shared_data.h"
+#include "tracer.h"
 
 const int NAMED_PIPE_MODE = S_IFIFO | 0640;
-const int READ_BUFF = 1024;
-const int MAX_SOFT_RETRY = 10;
+const int READ_BUFF = 65536;
+const size_t INPUT_MAP_CHUNK = 1 << 20;
+const int BACKLOG_SEGMENT = 65536;
+const long long CONFIRM_TIMEOUT = 5000000; // Time for confirmation of cancellation, microseconds
 
-enum _comm_status
+static const char *node_track[NODES_COUNT] = {"f", "g"};
+
+struct _pos_queue
 {
-    CS_NONE,
-    CS_SENT,
-    CS_RECEIVED,
+    int *items;   // Circular buffer of queue positions
+    int head;     // Index of the first item
+    int count;    // Number of items
+    int capacity; // Size of circular buffer
 };
 
-/// @brief Is data send over named pipe, is response received?
-typedef enum _comm_status comm_status_t;
+/// @brief FIFO of input queue positions, for values waiting for transmission or result
+typedef struct _pos_queue pos_queue_t;
 
-struct _calculated_value
+struct _trace_mark
 {
-    comm_status_t comm;
-    int soft_retry; // Retry counter, shouldn't exceed MAX_SOFT_RETRY
-    value_t value;
+    long long seq;   // Sequence number of input value
+    long long value; // Read time of values before seq, or x of printed value
 };
 
-/// @brief Calculated value and relates states
-typedef struct _calculated_value calculated_value_t;
+typedef struct _trace_mark trace_mark_t;
 
-struct _input_value
+struct _mark_queue
 {
-    int value;
-    calculated_value_t result[NODES_COUNT];
+    trace_mark_t *items; // Circular buffer, grows on demand
+    int head;            // Index of the first item
+    int count;           // Number of items
+    int capacity;        // Size of circular buffer
 };
 
-/// @brief Input value and calculated results
-typedef struct _input_value input_value_t;
+/// @brief FIFO of marks in order of sequence numbers, for traced read and print times of values
+typedef struct _mark_queue mark_queue_t;
 
 struct _manager_state
 {
     pid_t comp_nodes[NODES_COUNT];                // Reference to processes for computation
     int comm_fd[NODES_COUNT];                     // File descriptors for communication channels
+    char pipe_path[NODES_COUNT][2][PATH_MAX];     // Named pipes of nodes, unique for manager process
     int input_fd[NODES_COUNT + 1];                // File descriptors for results communication channels, extra space for input stream
     int max_count;                                // Size of communication buffers
-    input_value_t *x_values;                      // Input and results queue
+    backlog_t *backlog;                           // Input values, waiting for free space in queue
+    input_parser_t *parser;                       // Tokenizer of input stream
+    char *input_buff;                             // Buffer for reading input stream
+    const char *input_map;                        // Memory mapped input file, NULL for input stream
+    size_t input_map_size;                        // Size of input file
+    size_t input_map_pos;                         // Parsed part of input file
+    bool input_eof;                               // All input values are received
+    result_log_t *log;                            // Log of input values and results, NULL if disabled
+    log_replay_t replay;                          // Values restored from log, waiting for free space in queue
+    long long replay_pos;                         // Index of the first restored value, not moved to queue
+    long long input_skip;                         // Number of input values to drop, they are restored from log
+    long long head_seq;                           // Sequence number of value at x_head_pos
+    long long next_seq;                           // Sequence number of the next value, entering the queue
+    aggregate_t *aggregate;                       // Window summaries of final results, NULL to print every result
+    columnar_writer_t *columnar;                  // Columnar results file, NULL if disabled
+    output_t *output;                             // Asynchronous writer of trace and final lines
+    bool trace;                                   // Print results of f(x) and g(x)
+    metrics_t *metrics;                           // Counters and latency histograms
+    long long *enqueued_at;                       // Time of entering the queue, in queue order
+    long long *sent_at[NODES_COUNT];              // Time of transmission to f and g, in queue order
+    tracer_t *tracer;                             // Lifecycle tracing of sampled values, NULL if disabled
+    long long backlog_popped;                     // Number of values taken from backlog, including skipped ones
+    mark_queue_t read_marks;                      // Read times of parsed values, seq counts values taken from backlog
+    mark_queue_t print_marks;                     // Traced final values, waiting for output thread
+    const char *virtual_clock;                    // Clock file of simulated time, NULL if delays are real
+    bool worker_clock;                            // Workers share the clock, their results are pending work until read
+    int signal_fd;                                // Signals delivered to event loop, -1 if not handled
+    long long confirm_deadline;                   // End of cancellation confirmation, real time in microseconds, 0 if not asked
+    bool cancel_confirmed;                        // Operator confirmed cancellation
+    int *x_values;                                // Input values queue
+    calculated_value_t *calc_state[NODES_COUNT];  // Communication state of f(x) and g(x), in queue order
+    value_column_t results[NODES_COUNT];          // Calculated f(x) and g(x), in queue order
+    final_stage_t final;                          // Final operations, in queue order
+    pos_queue_t pending[NODES_COUNT];             // Positions waiting for transmission to f and g, including retries
+    pos_queue_t in_flight[NODES_COUNT];           // Positions sent to f and g, in order of transmission
     int x_head_pos;                               // Index of calculated element in circular input queue
-    int x_current_pos;                            // Index of current value for calculation
+    int x_current_pos;                            // Index of the first value waiting for results
     int x_free_pos;                               // Index of free element in circular input queue
     trial_function_t trial_function[NODES_COUNT]; // Trial function
     tf_result_t output_type[NODES_COUNT];         // Output value type
-    trial_function_t final_function;              // Final operation
     bool shutdown;                                // No more input values
 };
 
-static char node_name[NODES_COUNT] = {'f', 'g'};
+static void pos_queue_init(pos_queue_t *q, int capacity)
+{
+    q->items = malloc(sizeof(q->items[0]) * capacity);
+    q->head = 0;
+    q->count = 0;
+    q->capacity = capacity;
+}
+
+static void pos_queue_push(pos_queue_t *q, int pos)
+{
+    q->items[(q->head + q->count) % q->capacity] = pos;
+    q->count++;
+}
+
+static int pos_queue_pop(pos_queue_t *q)
+{
+    int pos = q->items[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+    return pos;
+}
+
+static bool mark_queue_push(mark_queue_t *q, long long seq, long long value)
+{
+    if (q->count == q->capacity)
+    {
+        int capacity = q->capacity > 0 ? q->capacity * 2 : 64;
+        trace_mark_t *items = malloc(sizeof(trace_mark_t) * capacity);
+
+        if (items == NULL)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < q->count; i++)
+        {
+            items[i] = q->items[(q->head + i) % q->capacity];
+        }
+
+        free(q->items);
+        q->items = items;
+        q->head = 0;
+        q->capacity = capacity;
+    }
+
+    q->items[(q->head + q->count) % q->capacity] = (trace_mark_t){seq, value};
+    q->count++;
+
+    return true;
+}
+
+static trace_mark_t *mark_queue_front(mark_queue_t *q)
+{
+    return q->count > 0 ? &q->items[q->head] : NULL;
+}
+
+static void mark_queue_pop(mark_queue_t *q)
+{
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+}
 
-manager_state_t *construct_manager(int input_fd, int buffer_size, const char *f_func, const char *g_func, const char *final_func)
+/// @brief Remember read time of values, which are parsed into backlog
+static void trace_read(manager_state_t *mgr)
 {
+    if (mgr->tracer == NULL)
+    {
+        return;
+    }
+
+    long long parsed = mgr->backlog_popped + backlog_size(mgr->backlog);
+    trace_mark_t *last = mgr->read_marks.count > 0 ? &mgr->read_marks.items[(mgr->read_marks.head + mgr->read_marks.count - 1) % mgr->read_marks.capacity] : NULL;
+
+    if (last == NULL || last->seq < parsed)
+    {
+        mark_queue_push(&mgr->read_marks, parsed, trace_now());
+    }
+}
+
+/// @brief Read time of value taken from backlog
+/// @param seq Number of values taken from backlog before it
+static long long read_time(manager_state_t *mgr, long long seq)
+{
+    trace_mark_t *mark;
+
+    while ((mark = mark_queue_front(&mgr->read_marks)) != NULL && mark->seq <= seq)
+    {
+        mark_queue_pop(&mgr->read_marks);
+    }
+
+    return mark != NULL ? mark->value : trace_now();
+}
+
+/// @brief Instant events of traced final values, which lines are written by output thread
+static void trace_printed(manager_state_t *mgr)
+{
+    long long written = output_written(mgr->output);
+    long long now = trace_now();
+    trace_mark_t *mark;
+
+    while ((mark = mark_queue_front(&mgr->print_marks)) != NULL && mark->seq < written)
+    {
+        trace_instant(mgr->tracer, 0, "printed", (int)mark->value, now);
+        mark_queue_pop(&mgr->print_marks);
+    }
+}
+
+manager_state_t *construct_manager(const manager_options_t *opts)
+{
+    int buffer_size = opts->buffer_size;
+    const char *f_func = opts->f_func;
+    const char *g_func = opts->g_func;
+
+    const char *node_funcs[NODES_COUNT] = {f_func, g_func};
+
+    // Replay worker exits on mismatch, before opening of named pipes
+    for (int i = 0; i < NODES_COUNT && opts->replay_prefix != NULL; i++)
+    {
+        char record_file[PATH_MAX];
+        snprintf(record_file, sizeof(record_file), "%s.%s", opts->replay_prefix, node_track[i]);
+
+        if (!check_recording(record_file, i, node_funcs[i]))
+        {
+            return NULL;
+        }
+    }
+
+    // Workers map the same tables, invalid file is reported before their start
+    if (opts->cases_file != NULL && trial_cases_load(opts->cases_file) != 0)
+    {
+        fprintf(stderr, "manager: Invalid case tables %s\n", opts->cases_file);
+        return NULL;
+    }
+
+    if (opts->faults != NULL && trial_faults_config(opts->faults) != 0)
+    {
+        fprintf(stderr, "manager: Invalid fault injection %s\n", opts->faults);
+        return NULL;
+    }
+
+    // Simulated time starts before metrics and trace, workers attach to the clock.
+    // Clock of load generator is shared, it measures latency in simulated time
+    if (opts->virtual_clock != NULL &&
+        (access(opts->virtual_clock, F_OK) == 0 ? trial_clock_attach(opts->virtual_clock) : trial_clock_create(opts->virtual_clock)) != 0)
+    {
+        fprintf(stderr, "manager: Failed to create virtual clock %s\n", opts->virtual_clock);
+        return NULL;
+    }
+
+    // Manager holds the clock while it runs, it gives it back in select()
+    trial_clock_work(1);
+
     manager_state_t *mgr = malloc(sizeof(manager_state_t));
 
-    // Create named pipes
-    mkfifo(node_pipe[F_NODE][0], NAMED_PIPE_MODE);
-    mkfifo(node_pipe[F_NODE][1], NAMED_PIPE_MODE);
-    mkfifo(node_pipe[G_NODE][0], NAMED_PIPE_MODE);
-    mkfifo(node_pipe[G_NODE][1], NAMED_PIPE_MODE);
+    mgr->virtual_clock = opts->virtual_clock;
+    mgr->worker_clock = opts->virtual_clock != NULL && opts->replay_prefix == NULL;
+    mgr->signal_fd = opts->signal_fd;
+    mgr->confirm_deadline = 0;
+    mgr->cancel_confirmed = false;
+
+    // Create named pipes, several managers could run on the same host
+    for (int i = 0; i < NODES_COUNT; i++)
+    {
+        for (int j = 0; j < 2; j++)
+        {
+            snprintf(mgr->pipe_path[i][j], PATH_MAX, "%s_%d", node_pipe[i][j], getpid());
+            mkfifo(mgr->pipe_path[i][j], NAMED_PIPE_MODE);
+        }
+    }
 
     // Allocate buffers
     mgr->max_count = buffer_size;
-    mgr->x_values = malloc(sizeof(input_value_t) * buffer_size);
+    mgr->x_values = malloc(sizeof(mgr->x_values[0]) * buffer_size);
     mgr->x_head_pos = 0;
     mgr->x_current_pos = 0;
     mgr->x_free_pos = 0;
 
-    // Launch computation processes, at first
-    int status;
-    char *args[] = {
-        calc_task,
-        "f",
-        f_func,
-        NULL};
+    mgr->metrics = construct_metrics(opts->stats_file);
+    mgr->enqueued_at = malloc(sizeof(mgr->enqueued_at[0]) * buffer_size);
+    if (mgr->metrics == NULL || mgr->enqueued_at == NULL)
+    {
+        fprintf(stderr, "manager: Metrics allocation failed\n");
+        return NULL;
+    }
+
+    mgr->metrics->queue_size = buffer_size;
+
+    mgr->backlog = construct_backlog(BACKLOG_SEGMENT, opts->backlog_limit, opts->spill_dir);
+    mgr->parser = construct_input_parser(opts->binary_input);
+    mgr->input_buff = malloc(READ_BUFF);
+    if (mgr->backlog == NULL || mgr->parser == NULL || mgr->input_buff == NULL)
+    {
+        fprintf(stderr, "manager: Input buffers allocation failed\n");
+        return NULL;
+    }
+
+    // Input file is parsed directly from memory map
+    mgr->input_map = NULL;
+    mgr->input_map_size = 0;
+    mgr->input_map_pos = 0;
+    mgr->input_eof = false;
+
+    if (opts->input_file != NULL)
+    {
+        int fd = open(opts->input_file, O_RDONLY);
+        struct stat st;
+
+        if (fd == -1 || fstat(fd, &st) == -1)
+        {
+            fprintf(stderr, "manager: Failed to open input file %s\n", opts->input_file);
+            return NULL;
+        }
+
+        mgr->input_map_size = st.st_size;
+
+        if (mgr->input_map_size > 0)
+        {
+            void *map = mmap(NULL, mgr->input_map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED)
+            {
+                fprintf(stderr, "manager: Failed to map input file %s\n", opts->input_file);
+                close(fd);
+                return NULL;
+            }
+            madvise(map, mgr->input_map_size, MADV_SEQUENTIAL);
+            mgr->input_map = map;
+        }
+        else
+        {
+            mgr->input_eof = true;
+        }
+
+        // Mapping stays valid after close
+        close(fd);
+    }
+
+    // Restore values, which are not printed before interruption
+    mgr->log = NULL;
+    memset(&mgr->replay, 0, sizeof(mgr->replay));
+    mgr->replay_pos = 0;
+    mgr->input_skip = 0;
+    mgr->head_seq = 0;
+    mgr->next_seq = 0;
 
-    status = posix_spawn(&mgr->comp_nodes[F_NODE], calc_task, NULL, NULL, args, NULL);
-    if (status != 0)
+    if (opts->log_file != NULL)
     {
-        printf("f node - failed\n");
+        const char *funcs[3] = {f_func, g_func, opts->final_func};
+
+        if (opts->resume)
+        {
+            if (!result_log_replay(opts->log_file, funcs, &mgr->replay))
+            {
+                fprintf(stderr, "manager: Failed to replay log %s\n", opts->log_file);
+                return NULL;
+            }
+
+            mgr->input_skip = mgr->replay.inputs;
+            mgr->head_seq = mgr->next_seq = mgr->replay.first_seq;
+
+            fprintf(stderr, "manager: Resume, %lld values are printed, %lld values are restored\n", mgr->replay.first_seq, mgr->replay.count);
+        }
+
+        mgr->log = construct_result_log(opts->log_file, funcs, opts->resume);
+        if (mgr->log == NULL)
+        {
+            fprintf(stderr, "manager: Failed to open log %s\n", opts->log_file);
+            return NULL;
+        }
+    }
+
+    // Trace file is created before workers, they append to it
+    mgr->tracer = NULL;
+    mgr->backlog_popped = 0;
+    memset(&mgr->read_marks, 0, sizeof(mgr->read_marks));
+    memset(&mgr->print_marks, 0, sizeof(mgr->print_marks));
+
+    if (opts->trace_file != NULL)
+    {
+        mgr->tracer = construct_tracer(opts->trace_file, true, "manager", opts->trace_sample);
+        if (mgr->tracer == NULL)
+        {
+            return NULL;
+        }
+
+        trace_thread_name(mgr->tracer, 0, "dispatch");
+        trace_thread_name(mgr->tracer, 1 + F_NODE, "f channel");
+        trace_thread_name(mgr->tracer, 1 + G_NODE, "g channel");
     }
 
-    args[1] = "g";
-    args[2] = g_func;
+    // Launch computation processes, at first. Replay workers stand in for calculon, if requested
 
-    status = posix_spawn(&mgr->comp_nodes[G_NODE], calc_task, NULL, NULL, args, NULL);
-    if (status != 0)
+    for (int i = 0; i < NODES_COUNT; i++)
     {
-        printf("g node - failed\n");
+        const char *task = opts->replay_prefix != NULL ? replay_task : calc_task;
+        char trace_arg[PATH_MAX + 16];
+        char record_arg[PATH_MAX];
+        char *args[18];
+        int n = 0;
+
+        args[n++] = (char *)task;
+
+        if (opts->replay_prefix != NULL)
+        {
+            snprintf(record_arg, sizeof(record_arg), "%s.%s", opts->replay_prefix, node_track[i]);
+
+            if (opts->replay_timed)
+            {
+                args[n++] = "-T";
+            }
+            args[n++] = record_arg;
+        }
+        else
+        {
+            if (opts->trace_file != NULL)
+            {
+                snprintf(trace_arg, sizeof(trace_arg), "%s:%d", opts->trace_file, opts->trace_sample);
+                args[n++] = "-t";
+                args[n++] = trace_arg;
+            }
+            if (opts->record_prefix != NULL)
+            {
+                snprintf(record_arg, sizeof(record_arg), "%s.%s", opts->record_prefix, node_track[i]);
+                args[n++] = "-w";
+                args[n++] = record_arg;
+            }
+            if (opts->virtual_clock != NULL)
+            {
+                args[n++] = "-V";
+                args[n++] = (char *)opts->virtual_clock;
+            }
+            if (opts->cases_file != NULL)
+            {
+                args[n++] = "-C";
+                args[n++] = (char *)opts->cases_file;
+            }
+            if (opts->faults != NULL)
+            {
+                args[n++] = "-F";
+                args[n++] = (char *)opts->faults;
+            }
+        }
+
+        args[n++] = (char *)node_track[i];
+        args[n++] = (char *)node_funcs[i];
+        args[n++] = mgr->pipe_path[i][0];
+        args[n++] = mgr->pipe_path[i][1];
+        args[n] = NULL;
+
+        // Signals of manager are blocked for signalfd, workers start with empty mask
+        posix_spawnattr_t attr;
+        sigset_t no_signals;
+
+        sigemptyset(&no_signals);
+        posix_spawnattr_init(&attr);
+        posix_spawnattr_setsigmask(&attr, &no_signals);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+        int status = posix_spawn(&mgr->comp_nodes[i], task, NULL, &attr, args, NULL);
+        posix_spawnattr_destroy(&attr);
+        if (status != 0)
+        {
+            fprintf(stderr, "%s node - failed\n", node_track[i]);
+        }
     }
 
     // Open file descriptors
     for (int i = 0; i < NODES_COUNT; i++)
     {
-        mgr->comm_fd[i] = open(node_pipe[i][0], O_WRONLY);
+        mgr->comm_fd[i] = open(mgr->pipe_path[i][0], O_WRONLY);
         if (mgr->comm_fd[i] == -1)
         {
-            fprintf(stderr, "manager: Named pipe open failed %s\n", node_pipe[i][0]);
+            fprintf(stderr, "manager: Named pipe open failed %s\n", mgr->pipe_path[i][0]);
             /// @todo Cleanup partially constructed object
             return NULL;
         }
@@ -121,16 +500,16 @@ manager_state_t *construct_manager(int input_fd, int buffer_size, const char *f_
 
     for (int i = 0; i < NODES_COUNT; i++)
     {
-        mgr->input_fd[i] = open(node_pipe[i][1], O_RDONLY);
+        mgr->input_fd[i] = open(mgr->pipe_path[i][1], O_RDONLY);
         if (mgr->input_fd[i] == -1)
         {
-            fprintf(stderr, "manager: Results named pipe open failed %s\n", node_pipe[i][1]);
+            fprintf(stderr, "manager: Results named pipe open failed %s\n", mgr->pipe_path[i][1]);
             /// @todo Cleanup partially constructed object
             return NULL;
         }
     }
 
-    mgr->input_fd[NODES_COUNT] = input_fd;
+    mgr->input_fd[NODES_COUNT] = opts->input_file == NULL ? opts->input_fd : -1;
 
     // Find maximal file descriptor, to check select system call requirements
     int nfds = mgr->input_fd[0];
@@ -147,7 +526,7 @@ manager_state_t *construct_manager(int input_fd, int buffer_size, const char *f_
 
     if (nfds >= FD_SETSIZE)
     {
-        printf("HUGE file descriptor - %d, upgrade to poll(2)\n", nfds);
+        fprintf(stderr, "HUGE file descriptor - %d, upgrade to poll(2)\n", nfds);
         return NULL;
     }
 
@@ -160,35 +539,359 @@ manager_state_t *construct_manager(int input_fd, int buffer_size, const char *f_
         mgr->output_type[i] = trial_result_type(mgr->trial_function[i]);
     }
 
-    // Final function
-    mgr->final_function = function_from_name(final_func);
+    // Result columns
+    for (int i = 0; i < NODES_COUNT; i++)
+    {
+        mgr->calc_state[i] = calloc(buffer_size, sizeof(calculated_value_t));
+        pos_queue_init(&mgr->pending[i], buffer_size);
+        pos_queue_init(&mgr->in_flight[i], buffer_size);
+        mgr->sent_at[i] = malloc(sizeof(mgr->sent_at[i][0]) * buffer_size);
+        column_init(&mgr->results[i], mgr->output_type[i], buffer_size);
+    }
+
+    // Final functions, comma separated list, cast is required only if node type differs from final type
+    trial_function_t final_funcs[TF_COUNT];
+    int final_count = functions_from_list(opts->final_func, final_funcs);
+
+    final_stage_init(&mgr->final, final_funcs, final_count, mgr->results, buffer_size);
+
+    mgr->output = construct_output(STDOUT_FILENO, opts->output_format);
+
+    if (mgr->output == NULL)
+    {
+        fprintf(stderr, "manager: Failed to start output thread\n");
+        return NULL;
+    }
+
+    mgr->aggregate = NULL;
+
+    if (opts->window != NULL)
+    {
+        // Window summaries are made for single final operation, they go through output with other results
+        mgr->aggregate = construct_aggregate(opts->window, mgr->final.type[0], mgr->output);
+        if (mgr->aggregate == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    mgr->trace = !opts->quiet && mgr->aggregate == NULL;
+
+    mgr->columnar = NULL;
+
+    if (opts->columnar_file != NULL)
+    {
+        const char *funcs[COLUMNAR_COLUMNS] = {f_func, g_func, opts->final_func};
+        tf_result_t types[COLUMNAR_COLUMNS] = {mgr->output_type[F_NODE], mgr->output_type[G_NODE], mgr->final.type[0]};
+
+        mgr->columnar = construct_columnar_writer(opts->columnar_file, funcs, types);
+        if (mgr->columnar == NULL)
+        {
+            fprintf(stderr, "manager: Failed to create results file %s\n", opts->columnar_file);
+            return NULL;
+        }
+    }
 
     mgr->shutdown = false;
 
     return mgr;
 }
 
-void destruct_manager(manager_state_t *mgr)
+bool destruct_manager(manager_state_t *mgr)
 {
     /// @todo Sync computation queues
 
+    if (mgr->aggregate != NULL)
+    {
+        aggregate_finish(mgr->aggregate);
+        destruct_aggregate(mgr->aggregate);
+    }
+
+    if (mgr->columnar != NULL)
+    {
+        destruct_columnar_writer(mgr->columnar);
+    }
+
     // Close file descriptors
     for (int i = 0; i < NODES_COUNT; i++)
     {
         close(mgr->comm_fd[i]);
         close(mgr->input_fd[i]);
-        remove(node_pipe[i][0]);
-        remove(node_pipe[i][1]);
+        remove(mgr->pipe_path[i][0]);
+        remove(mgr->pipe_path[i][1]);
     }
 
     // Free buffers
+    if (mgr->input_map != NULL)
+    {
+        munmap((void *)mgr->input_map, mgr->input_map_size);
+    }
+
+    // Values are printed, only if their lines are written
+    output_mark(mgr->output, mgr->head_seq);
+    output_flush(mgr->output, true);
+
+    bool written = !output_failed(mgr->output);
+
+    if (mgr->log != NULL)
+    {
+        log_printed(mgr->log, output_written(mgr->output));
+        destruct_result_log(mgr->log);
+    }
+
+    if (mgr->tracer != NULL)
+    {
+        trace_printed(mgr);
+        destruct_tracer(mgr->tracer);
+    }
+
+    destruct_output(mgr->output);
+
+    free(mgr->read_marks.items);
+    free(mgr->print_marks.items);
+
+    free_log_replay(&mgr->replay);
+    free(mgr->input_buff);
+    destruct_input_parser(mgr->parser);
+    destruct_backlog(mgr->backlog);
     free(mgr->x_values);
 
+    for (int i = 0; i < NODES_COUNT; i++)
+    {
+        free(mgr->calc_state[i]);
+        free(mgr->pending[i].items);
+        free(mgr->in_flight[i].items);
+        free(mgr->sent_at[i]);
+        column_free(&mgr->results[i]);
+    }
+
+    final_stage_free(&mgr->final);
+
+    destruct_metrics(mgr->metrics);
+    free(mgr->enqueued_at);
+
+    // Workers keep their mapping of the clock
+    if (mgr->virtual_clock != NULL)
+    {
+        trial_clock_release();
+        fprintf(stderr, "manager: Simulated time %lld ms\n", trial_clock_usecs() / 1000);
+        remove(mgr->virtual_clock);
+    }
+
     free(mgr);
+
+    return written;
+}
+
+/// @brief Move values restored from log to the queue, known results are not calculated again
+/// @return Number of moved values
+static int restore_values(manager_state_t *mgr, int pos, int max)
+{
+    int count = MIN(max, mgr->replay.count - mgr->replay_pos);
+
+    for (int j = 0; j < count; j++, pos++)
+    {
+        const log_entry_t *entry = &mgr->replay.entries[mgr->replay_pos++];
+
+        mgr->x_values[pos] = entry->x;
+
+        for (int i = 0; i < NODES_COUNT; i++)
+        {
+            memset(&mgr->calc_state[i][pos], 0, sizeof(calculated_value_t));
+
+            if (entry->known & (1 << i))
+            {
+                mgr->calc_state[i][pos].comm = CS_RECEIVED;
+                result_types[mgr->output_type[i]].store(&mgr->results[i], pos, &entry->result[i]);
+            }
+            else
+            {
+                pos_queue_push(&mgr->pending[i], pos);
+            }
+        }
+    }
+
+    if (mgr->replay_pos == mgr->replay.count)
+    {
+        free_log_replay(&mgr->replay);
+        mgr->replay_pos = 0;
+    }
+
+    return count;
+}
+
+/// @brief Move waiting input values from backlog to free space of circular queue
+static void refill_queue(manager_state_t *mgr)
+{
+    while (mgr->replay_pos < mgr->replay.count || backlog_size(mgr->backlog) > 0)
+    {
+        int limit = queue_free_end(mgr->x_head_pos, mgr->x_free_pos, mgr->max_count);
+        int count;
+        bool from_log = mgr->replay_pos < mgr->replay.count;
+
+        if (from_log)
+        {
+            count = restore_values(mgr, mgr->x_free_pos, limit - mgr->x_free_pos);
+        }
+        else if (mgr->input_skip > 0)
+        {
+            // Input values, logged before interruption, free space is used as scratch buffer
+            int skipped = backlog_pop(mgr->backlog, &mgr->x_values[mgr->x_free_pos], MIN(mgr->input_skip, limit - mgr->x_free_pos));
+            mgr->input_skip -= skipped;
+            mgr->backlog_popped += skipped;
+
+            if (skipped == 0)
+            {
+                break;
+            }
+            continue;
+        }
+        else
+        {
+            count = backlog_pop(mgr->backlog, &mgr->x_values[mgr->x_free_pos], limit - mgr->x_free_pos);
+
+            for (int pos = mgr->x_free_pos; pos < mgr->x_free_pos + count; pos++)
+            {
+                for (int i = 0; i < NODES_COUNT; i++)
+                {
+                    memset(&mgr->calc_state[i][pos], 0, sizeof(calculated_value_t));
+                    pos_queue_push(&mgr->pending[i], pos);
+                }
+
+                if (mgr->log != NULL)
+                {
+                    log_input(mgr->log, mgr->next_seq + pos - mgr->x_free_pos, mgr->x_values[pos]);
+                }
+            }
+        }
+
+        if (count == 0)
+        {
+            break;
+        }
+
+        long long now = metrics_now();
+
+        for (int pos = mgr->x_free_pos; pos < mgr->x_free_pos + count; pos++)
+        {
+            mgr->enqueued_at[pos] = now;
+
+            if (trace_sampled(mgr->tracer, mgr->x_values[pos]))
+            {
+                if (!from_log)
+                {
+                    trace_instant(mgr->tracer, 0, "input", mgr->x_values[pos], read_time(mgr, mgr->backlog_popped + pos - mgr->x_free_pos));
+                }
+                trace_instant(mgr->tracer, 0, "enqueue", mgr->x_values[pos], now);
+            }
+        }
+
+        if (!from_log)
+        {
+            mgr->backlog_popped += count;
+        }
+
+        mgr->next_seq += count;
+        mgr->x_free_pos = (mgr->x_free_pos + count) % mgr->max_count;
+    }
+}
+
+/// @brief Parse next chunk of memory mapped input file, file itself is a backlog
+/// @return False, on failure
+static bool parse_input_map(manager_state_t *mgr)
+{
+    if (mgr->input_map == NULL || mgr->input_eof || backlog_size(mgr->backlog) >= BACKLOG_SEGMENT)
+    {
+        return true;
+    }
+
+    size_t chunk = MIN(INPUT_MAP_CHUNK, mgr->input_map_size - mgr->input_map_pos);
+
+    bool parsed = input_parse(mgr->parser, mgr->input_map + mgr->input_map_pos, chunk, mgr->backlog);
+    trace_read(mgr);
+
+    if (!parsed)
+    {
+        return false;
+    }
+
+    mgr->input_map_pos += chunk;
+    mgr->metrics->input.bytes += chunk;
+
+    if (mgr->input_map_pos == mgr->input_map_size)
+    {
+        mgr->input_eof = true;
+        parsed = input_finish(mgr->parser, mgr->backlog);
+        trace_read(mgr);
+        return parsed;
+    }
+
+    return true;
+}
+
+/// @brief Real time for confirmation timeout, delays may be simulated
+static long long real_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+/// @brief Cancellation request or stats request
+static void handle_signal(manager_state_t *mgr, int signo)
+{
+    if (signo == SIGINT && mgr->confirm_deadline == 0 && !mgr->shutdown)
+    {
+        // Computation goes on, while operator decides
+        fprintf(stderr, "Please confirm that computation should be stopped y(es, stop)/n(ot yet)[n]\n");
+        mgr->confirm_deadline = real_now() + CONFIRM_TIMEOUT;
+    }
+    else if (signo == SIGUSR1)
+    {
+        print_stats(mgr, stderr);
+    }
+}
+
+/// @brief Handle signals, delivered through signalfd or self-pipe of the same records
+static void handle_signals(manager_state_t *mgr)
+{
+    struct signalfd_siginfo info;
+
+    while (read(mgr->signal_fd, &info, sizeof(info)) == sizeof(info))
+    {
+        handle_signal(mgr, info.ssi_signo);
+    }
+}
+
+/// @brief Read answer of operator, the only one per request
+static void read_confirmation(manager_state_t *mgr)
+{
+    char buff[50];
+
+    int retval = read(STDIN_FILENO, buff, sizeof(buff));
+
+    mgr->confirm_deadline = 0;
+
+    if (retval == 2 && (buff[0] == 'y' || buff[0] == 'Y'))
+    {
+        mgr->cancel_confirmed = true;
+    }
+    else
+    {
+        fprintf(stderr, "action is not confirmed. proceeding...\n");
+    }
 }
 
 bool communicate(manager_state_t *mgr)
 {
+    if (!parse_input_map(mgr))
+    {
+        fprintf(stderr, "manager: Backlog is out of memory\n");
+        return false;
+    }
+
+    refill_queue(mgr);
+
     fd_set data_streams;
     fd_set out_streams;
 
@@ -197,21 +900,38 @@ bool communicate(manager_state_t *mgr)
     // Input set
     FD_ZERO(&data_streams);
 
-    // X values and results data streams
-    int input_limit = mgr->shutdown ? NODES_COUNT :NODES_COUNT + 1;
+    // X values and results data streams, input waits in backlog while queue is full
+    bool input_stream = !mgr->shutdown && !mgr->input_eof && mgr->input_map == NULL;
+    int input_limit = input_stream ? NODES_COUNT + 1 : NODES_COUNT;
     for (int i = 0; i < input_limit; i++)
     {
         FD_SET(mgr->input_fd[i], &data_streams);
         nfds = MAX(nfds, mgr->input_fd[i]);
     }
 
+    // Answer of operator, it replaces the next chunk of input stream from terminal
+    bool confirming = mgr->confirm_deadline != 0;
+
+    if (confirming)
+    {
+        FD_SET(STDIN_FILENO, &data_streams);
+        nfds = MAX(nfds, STDIN_FILENO);
+        input_stream = input_stream && mgr->input_fd[NODES_COUNT] != STDIN_FILENO;
+    }
+
+    if (mgr->signal_fd != -1)
+    {
+        FD_SET(mgr->signal_fd, &data_streams);
+        nfds = MAX(nfds, mgr->signal_fd);
+    }
+
     // Send params to workers streams
     FD_ZERO(&out_streams);
 
     for (int i = 0; i < NODES_COUNT; i++)
     {
         // Is write operation expected
-        if (mgr->x_current_pos != mgr->x_free_pos && mgr->x_values[mgr->x_current_pos].result[i].comm == CS_NONE)
+        if (mgr->pending[i].count > 0)
         {
             FD_SET(mgr->comm_fd[i], &out_streams);
             nfds = MAX(nfds, mgr->comm_fd[i]);
@@ -225,7 +945,26 @@ bool communicate(manager_state_t *mgr)
     io_timeout.tv_sec = 0;
     io_timeout.tv_usec = 250000;
 
+    if (mgr->input_map != NULL && !mgr->input_eof && !mgr->shutdown)
+    {
+        // Input file is always ready, just check for other events
+        io_timeout.tv_usec = 0;
+    }
+
+    if (confirming)
+    {
+        io_timeout.tv_usec = MAX(0, MIN(io_timeout.tv_usec, mgr->confirm_deadline - real_now()));
+    }
+
+    trial_clock_work(-1);
     sel_result = select(nfds + 1, &data_streams, &out_streams, NULL, &io_timeout);
+    trial_clock_work(1);
+
+    if (confirming && (sel_result <= 0 || !FD_ISSET(STDIN_FILENO, &data_streams)) && real_now() >= mgr->confirm_deadline)
+    {
+        mgr->confirm_deadline = 0;
+        fprintf(stderr, "action is not confirmed within 5 seconds. proceeding...\n");
+    }
 
     if (sel_result == -1)
     {
@@ -233,7 +972,7 @@ bool communicate(manager_state_t *mgr)
 
         if (err == EINTR)
         {
-            // Interrupted by user
+            // Interrupted by signal, which is not delivered through signalfd
             return true;
         }
         else
@@ -250,30 +989,52 @@ bool communicate(manager_state_t *mgr)
 
     // printf("manager: select - %d\n", sel_result);
 
-    // Get input value, add it to queue
-    if (FD_ISSET(mgr->input_fd[NODES_COUNT], &data_streams))
+    if (mgr->signal_fd != -1 && FD_ISSET(mgr->signal_fd, &data_streams))
+    {
+        handle_signals(mgr);
+    }
+
+    if (confirming && FD_ISSET(STDIN_FILENO, &data_streams))
     {
-        // Assumption: Data is read by lines, one X value per line
-        char buff[READ_BUFF + 1]; // Extra char for zero string termination
-        ssize_t result = read(mgr->input_fd[NODES_COUNT], buff, READ_BUFF);
-        buff[result] = 0;
-        long value;
-        char *endptr;
-        errno = 0;
-        value = strtol(buff, &endptr, 10);
-        if (errno != 0)
+        read_confirmation(mgr);
+    }
+
+    // Get input values, add them to queue
+    if (input_stream && FD_ISSET(mgr->input_fd[NODES_COUNT], &data_streams))
+    {
+        // Every value of the chunk is parsed, incomplete line is carried to the next read
+        ssize_t result = read(mgr->input_fd[NODES_COUNT], mgr->input_buff, READ_BUFF);
+
+        bool parsed = true;
+
+        mgr->metrics->input.syscalls++;
+
+        if (result > 0)
         {
-            printf("Failed to parse input (%d) - %ld, %s", errno, result, buff);
+            mgr->metrics->input.bytes += result;
+            parsed = input_parse(mgr->parser, mgr->input_buff, result, mgr->backlog);
         }
-        else
+        else if (result == 0)
         {
-            // printf("Read %ld - %ld, %s", value, result, buff);
+            // End of input stream
+            mgr->input_eof = true;
+            parsed = input_finish(mgr->parser, mgr->backlog);
+        }
+        else if (errno != EINTR && errno != EAGAIN)
+        {
+            fprintf(stderr, "manager: Input read failed (%d)\n", errno);
+            mgr->input_eof = true;
+        }
+
+        trace_read(mgr);
 
-            // Add value to queue
-            memset(&mgr->x_values[mgr->x_free_pos], 0, sizeof(mgr->x_values[0]));
-            mgr->x_values[mgr->x_free_pos].value = (int)value;
-            mgr->x_free_pos = (mgr->x_free_pos + 1) % mgr->max_count;
+        if (!parsed)
+        {
+            fprintf(stderr, "manager: Backlog is out of memory\n");
+            return false;
         }
+
+        refill_queue(mgr);
     }
 
     // Get calculated results
@@ -281,61 +1042,110 @@ bool communicate(manager_state_t *mgr)
     {
         if (FD_ISSET(mgr->input_fd[i], &data_streams))
         {
-            value_t val[10];
+            // Results arrive in order of transmission, single write from node doesn't exceed PIPE_BUF
+            value_t val[PIPE_BUF / sizeof(value_t)];
             ssize_t result = read(mgr->input_fd[i], val, sizeof(val));
 
-            // Current implementation is limited to 1 result value from named pipe
-            if (result <= 0 || result > sizeof(val))
+            if (result <= 0 || result % sizeof(value_t) != 0 || result / sizeof(value_t) > mgr->in_flight[i].count)
             {
                 fprintf(stderr, "COMM failed %d: %lu\n", i, result);
                 return false;
             }
 
+            if (mgr->worker_clock)
+            {
+                trial_clock_work(-(long long)(result / sizeof(value_t)));
+            }
+
+            long long now = metrics_now();
+
+            mgr->metrics->received[i].syscalls++;
+            mgr->metrics->received[i].bytes += result;
+            mgr->metrics->results[i] += result / sizeof(value_t);
+
             for (int j = 0; j < result / sizeof(value_t); j++)
             {
-                input_value_t *current = &mgr->x_values[mgr->x_current_pos];
-                calculated_value_t *res_val = &current->result[i];
-                res_val->comm = CS_RECEIVED;
-                res_val->value = val[j];
-                printf("trial_%c_%s(%d) %s", node_name[i], tf_name(mgr->output_type[i]), current->value, symbolic_status(res_val->value.status));
-                if (res_val->value.status == COMPFUNC_SUCCESS)
+                int current = pos_queue_pop(&mgr->in_flight[i]);
+                calculated_value_t *state = &mgr->calc_state[i][current];
+                histogram_record(&mgr->metrics->node_latency[i], now - mgr->sent_at[i][current]);
+
+                if (trace_sampled(mgr->tracer, mgr->x_values[current]))
+                {
+                    trace_span(mgr->tracer, 1 + i, node_track[i], mgr->x_values[current], mgr->sent_at[i][current], now);
+                }
+
+                if (mgr->trace)
                 {
-                    printf("<");
-                    // Print actual value
-                    switch (mgr->output_type[i])
+                    output_trace(mgr->output, i, mgr->trial_function[i], mgr->x_values[current], &val[j]);
+                }
+
+                if (receive_result(state, &mgr->results[i], current, &val[j], !mgr->shutdown))
+                {
+                    // Retry calculation
+                    pos_queue_push(&mgr->pending[i], current);
+                    mgr->metrics->retries[i]++;
+
+                    if (trace_sampled(mgr->tracer, mgr->x_values[current]))
+                    {
+                        trace_instant(mgr->tracer, 1 + i, "retry", mgr->x_values[current], now);
+                    }
+
+                    if (mgr->trace)
                     {
-                    case TFR_INT:
-                        print_int_value(res_val->value.i_val);
-                        break;
-                    case TFR_UINT:
-                        print_unsigned_int_value(res_val->value.ui_val);
-                        break;
-                    case TFR_FLOAT:
-                        print_double_value(res_val->value.d_val);
-                        break;
-                    case TFR_BOOL:
-                        print__Bool_value(res_val->value.b_val);
-                        break;
+                        output_retry(mgr->output, i, mgr->trial_function[i], mgr->x_values[current]);
                     }
-                    printf(">");
                 }
-                printf("\n");
+                else
+                {
+                    mgr->metrics->hard_fails[i] += val[j].status != COMPFUNC_SUCCESS;
+                }
+
+                if (mgr->log != NULL && state->comm == CS_RECEIVED)
+                {
+                    // Sequence number from distance to the head of queue
+                    long long seq = mgr->head_seq + (current - mgr->x_head_pos + mgr->max_count) % mgr->max_count;
+                    log_result(mgr->log, seq, i, &val[j]);
+                }
             }
         }
     }
 
-    // Send X to calculators
+    // Send X to calculators, all pending values at once, single write doesn't exceed PIPE_BUF
     for (int i = 0; i < NODES_COUNT; i++)
     {
         if (FD_ISSET(mgr->comm_fd[i], &out_streams))
         {
-            int result = write(mgr->comm_fd[i], &mgr->x_values[mgr->x_current_pos].value, sizeof(mgr->x_values[mgr->x_current_pos].value));
+            int x_batch[PIPE_BUF / sizeof(int)];
+            int count = MIN(mgr->pending[i].count, PIPE_BUF / sizeof(int));
+
+            for (int j = 0; j < count; j++)
+            {
+                x_batch[j] = mgr->x_values[mgr->pending[i].items[(mgr->pending[i].head + j) % mgr->pending[i].capacity]];
+            }
+
+            // Values are pending work, before the worker can read them
+            trial_clock_post(mgr->comp_nodes[i], count);
+
+            int result = write(mgr->comm_fd[i], x_batch, sizeof(int) * count);
             if (result == -1)
             {
                 // write operation failed
                 return false;
             }
-            mgr->x_values[mgr->x_current_pos].result[i].comm = CS_SENT;
+
+            long long now = metrics_now();
+
+            mgr->metrics->sent[i].syscalls++;
+            mgr->metrics->sent[i].bytes += result;
+            mgr->metrics->values_sent[i] += count;
+
+            for (int j = 0; j < count; j++)
+            {
+                int pos = pos_queue_pop(&mgr->pending[i]);
+                mgr->calc_state[i][pos].comm = CS_SENT;
+                mgr->sent_at[i][pos] = now;
+                pos_queue_push(&mgr->in_flight[i], pos);
+            }
         }
     }
 
@@ -347,248 +1157,139 @@ void shutdown(manager_state_t *mgr)
     mgr->shutdown = true;
 }
 
-value_t cast_value(const value_t *src, tf_result_t from, tf_result_t to)
+bool manager_cancel_confirmed(manager_state_t *mgr)
+{
+    return mgr->cancel_confirmed;
+}
+
+bool manager_finished(manager_state_t *mgr)
 {
-    value_t result = {0};
+    return mgr->input_eof && backlog_size(mgr->backlog) == 0 && mgr->replay_pos == mgr->replay.count && mgr->x_head_pos == mgr->x_free_pos;
+}
+
+/// @brief Copy queue state to metrics
+static void update_gauges(manager_state_t *mgr)
+{
+    metrics_t *m = mgr->metrics;
 
-    result.status = src->status;
+    m->head_pos = mgr->x_head_pos;
+    m->current_pos = mgr->x_current_pos;
+    m->free_pos = mgr->x_free_pos;
+    m->backlog = backlog_size(mgr->backlog);
 
-    switch (from)
+    for (int i = 0; i < NODES_COUNT; i++)
     {
-    case TFR_INT:
-        switch (to)
-        {
-        case TFR_UINT:
-            result.ui_val = src->i_val;
-            break;
-        case TFR_FLOAT:
-            result.d_val = src->i_val;
-            break;
-        case TFR_BOOL:
-            result.b_val = src->i_val;
-            break;
-        }
-        break;
-    case TFR_UINT:
-        switch (to)
-        {
-        case TFR_INT:
-            result.i_val = src->ui_val;
-            break;
-        case TFR_FLOAT:
-            result.d_val = src->ui_val;
-            break;
-        case TFR_BOOL:
-            result.b_val = src->ui_val;
-            break;
-        }
-        break;
-    case TFR_FLOAT:
-        switch (to)
-        {
-        case TFR_INT:
-            result.i_val = src->d_val;
-            break;
-        case TFR_UINT:
-            result.ui_val = src->d_val;
-            break;
-        case TFR_BOOL:
-            result.b_val = src->d_val;
-            break;
-        }
-        break;
-    case TFR_BOOL:
-        switch (to)
-        {
-        case TFR_INT:
-            result.i_val = src->b_val;
-            break;
-        case TFR_UINT:
-            result.ui_val = src->b_val;
-            break;
-        case TFR_FLOAT:
-            result.d_val = src->b_val;
-            break;
-        }
-        break;
+        m->pending[i] = mgr->pending[i].count;
+        m->in_flight[i] = mgr->in_flight[i].count;
     }
+}
 
-    return result;
+void print_stats(manager_state_t *mgr, FILE *stream)
+{
+    update_gauges(mgr);
+    metrics_print(mgr->metrics, stream);
 }
 
 bool final_calculation(manager_state_t *mgr)
 {
-    // Check for data availability
-    if (mgr->x_current_pos != mgr->x_free_pos)
+    // Advance over values with both results available, soft fails are already scheduled for retry
+    mgr->x_current_pos = queue_ready_end(mgr->calc_state, mgr->x_current_pos, mgr->x_free_pos, mgr->max_count);
+
+    // Calculate results, ready range is split in two, if it wraps around circular queue
+    while (mgr->x_head_pos != mgr->x_current_pos)
     {
-        // Values in transmission
-        input_value_t *current = &mgr->x_values[mgr->x_current_pos];
+        int begin = mgr->x_head_pos;
+        int end = mgr->x_current_pos > begin ? mgr->x_current_pos : mgr->max_count;
 
-        bool avail = true;
+        final_stage_run(&mgr->final, mgr->results, begin, end - begin);
 
-        for (int i = 0; i < NODES_COUNT; i++)
+        if (mgr->columnar != NULL)
         {
-            if (current->result[i].comm == CS_RECEIVED)
-            {
-                if (current->result[i].value.status == COMPFUNC_SOFT_FAIL && current->result[i].soft_retry < MAX_SOFT_RETRY && !mgr->shutdown)
-                {
-                    // Retry calculation
-                    current->result[i].soft_retry++;
-                    current->result[i].comm = CS_NONE;
-                    avail = false;
-                    printf("Retry soft fail - trial_%c_%s(%d)\n", node_name[i], tf_name(mgr->trial_function[i]), current->value);
-                }
-            }
-            else
+            const value_column_t *cols[COLUMNAR_COLUMNS] = {&mgr->results[F_NODE], &mgr->results[G_NODE], &mgr->final.results[0]};
+
+            if (!columnar_append(mgr->columnar, mgr->x_values, cols, begin, end - begin))
             {
-                avail = false;
+                fprintf(stderr, "manager: Failed to write results file\n");
+                return false;
             }
         }
 
-        if (!avail)
+        if (mgr->aggregate != NULL)
         {
-            // Not all data available
-            return false;
+            // Only window summaries are printed
+            aggregate_column(mgr->aggregate, &mgr->final.results[0], begin, end - begin);
         }
 
-        // Shift data pointer
-        mgr->x_current_pos = (mgr->x_current_pos + 1) % mgr->max_count;
-    }
+        long long now = metrics_now();
 
-    // Calculate results
-    int upper_limit = mgr->x_current_pos;
-    if (mgr->x_head_pos > mgr->x_current_pos)
-    {
-        //
-        upper_limit += mgr->max_count;
-    }
+        for (int i = begin; i < end; i++)
+        {
+            histogram_record(&mgr->metrics->end_to_end, now - mgr->enqueued_at[i]);
 
-    tf_result_t final_type = trial_result_type(mgr->final_function);
+            // Value fails, if any of its operations fails
+            bool failed = false;
 
-    for (int i = mgr->x_head_pos; i < upper_limit; i++)
-    {
-        printf("Final expression for %d ", mgr->x_values[i % mgr->max_count].value);
+            for (int k = 0; k < mgr->final.count; k++)
+            {
+                failed |= mgr->final.results[k].status[i] != COMPFUNC_SUCCESS;
+            }
 
-        value_t arg1;
+            mgr->metrics->final_fails += failed;
 
-        if (mgr->output_type[0] != final_type)
-        {
-            arg1 = cast_value(&mgr->x_values[i % mgr->max_count].result[0].value, mgr->output_type[0], final_type);
-        }
-        else
-        {
-            arg1 = mgr->x_values[i % mgr->max_count].result[0].value;
+            if (trace_sampled(mgr->tracer, mgr->x_values[i]))
+            {
+                // Final line is formatted right after, written by output thread
+                trace_span(mgr->tracer, 0, "value", mgr->x_values[i], mgr->enqueued_at[i], now);
+                trace_instant(mgr->tracer, 0, "final", mgr->x_values[i], now);
+                mark_queue_push(&mgr->print_marks, mgr->head_seq + i - begin, mgr->x_values[i]);
+            }
         }
 
-        value_t arg2;
+        mgr->metrics->finals += end - begin;
 
-        if (mgr->output_type[1] != final_type)
+        // Operations are labelled, if there are several of them
+        for (int i = begin; mgr->aggregate == NULL && i < end; i++)
         {
-            arg2 = cast_value(&mgr->x_values[i % mgr->max_count].result[1].value, mgr->output_type[1], final_type);
-        }
-        else
-        {
-            arg2 = mgr->x_values[i % mgr->max_count].result[1].value;
-        }
-
-        // Calculate
-        switch (mgr->final_function)
-        {
-        case TF_IMUL:
-            if (arg1.status == COMPFUNC_SUCCESS && arg2.status == COMPFUNC_SUCCESS)
-            {
-                print_int_value(arg1.i_val * arg2.i_val);
-            }
-            else
+            for (int k = 0; k < mgr->final.count; k++)
             {
-                printf("calculation failed");
+                value_t result;
+                result_types[mgr->final.type[k]].load(&mgr->final.results[k], i, &result);
+                output_final(mgr->output, mgr->final.function[k], mgr->final.count > 1, mgr->x_values[i], &result);
             }
-            break;
-        case TF_IMIN:
-            if (arg1.status == COMPFUNC_SUCCESS && arg2.status == COMPFUNC_SUCCESS)
-            {
-                print_unsigned_int_value(MIN(arg1.ui_val, arg2.ui_val));
-            }
-            else
-            {
-                printf("calculation failed");
-            }
-            break;
-        case TF_FMUL:
-            if (arg1.status == COMPFUNC_SUCCESS && arg2.status == COMPFUNC_SUCCESS)
-            {
-                print_double_value(arg1.d_val * arg2.d_val);
-            }
-            else
-            {
-                printf("calculation failed");
-            }
-            break;
-        case TF_AND:
-            if (arg1.status == COMPFUNC_SUCCESS && arg2.status == COMPFUNC_SUCCESS)
-            {
-                print__Bool_value(arg1.d_val && arg2.d_val);
-            }
-            else
-            {
-                bool partial_eval = false;
-
-                if (arg1.status == COMPFUNC_SUCCESS)
-                {
-                    partial_eval = !arg1.b_val;
-                }
-                else if (arg2.status == COMPFUNC_SUCCESS)
-                {
-                    partial_eval = !arg2.b_val;
-                }
+        }
 
-                // False if one of args is False
-                if (partial_eval)
-                {
-                    print__Bool_value(false);
-                }
-                else
-                {
-                    printf("calculation failed");
-                }
-            }
+        mgr->x_head_pos = end % mgr->max_count;
+        mgr->head_seq += end - begin;
+    }
 
-            break;
-        case TF_OR:
-            if (arg1.status == COMPFUNC_SUCCESS && arg2.status == COMPFUNC_SUCCESS)
-            {
-                print__Bool_value(arg1.d_val || arg2.d_val);
-            }
-            else
-            {
-                bool partial_eval = false;
+    if (mgr->aggregate != NULL)
+    {
+        aggregate_tick(mgr->aggregate);
+    }
 
-                if (arg1.status == COMPFUNC_SUCCESS)
-                {
-                    partial_eval = arg1.b_val;
-                }
-                else if (arg2.status == COMPFUNC_SUCCESS)
-                {
-                    partial_eval = arg2.b_val;
-                }
+    update_gauges(mgr);
+    histogram_record(&mgr->metrics->occupancy, (mgr->x_free_pos - mgr->x_head_pos + mgr->max_count) % mgr->max_count);
+    metrics_tick(mgr->metrics);
 
-                // True if one of args is True
-                if (partial_eval)
-                {
-                    print__Bool_value(true);
-                }
-                else
-                {
-                    printf("calculation failed");
-                }
-            }
+    // Lines are written by output thread, log knows only written values as printed
+    output_mark(mgr->output, mgr->head_seq);
+    output_flush(mgr->output, false);
 
-            break;
-        }
+    if (output_failed(mgr->output))
+    {
+        fprintf(stderr, "manager: Results are not written\n");
+        return false;
+    }
 
-        printf("\n");
+    if (mgr->tracer != NULL)
+    {
+        trace_printed(mgr);
+    }
 
-        mgr->x_head_pos = (mgr->x_head_pos + 1) % mgr->max_count;
+    if (mgr->log != NULL)
+    {
+        log_printed(mgr->log, output_written(mgr->output));
+        return flush_result_log(mgr->log);
     }
 
     return true;
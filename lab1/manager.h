@@ -2,6 +2,10 @@
 #define __MANAGER_INC__
 
 #include <stdbool.h>
+#include <stdio.h>
+
+#include "aggregate.h"
+#include "output.h"
 
 /// @brief Encapsulate manager data in this structure.
 ///
@@ -16,17 +20,46 @@
 ///   - calculate f*g, send result
 typedef struct _manager_state manager_state_t;
 
+struct _manager_options
+{
+    int input_fd;                  // File descriptor for reading input values
+    int buffer_size;               // Number of values in computation, size of input and output buffers
+    const char *f_func;            // Specify f(x)
+    const char *g_func;            // Specify g(x)
+    const char *final_func;        // Specify final operation
+    long long backlog_limit;       // Number of waiting input values kept in memory
+    const char *spill_dir;         // Directory for waiting input values over backlog_limit, NULL to keep them in memory
+    const char *input_file;        // Input file, parsed from memory map instead of input_fd, NULL to use input_fd
+    bool binary_input;             // Input is a sequence of raw int32 values, instead of text lines
+    const char *log_file;          // Log of input values and results, NULL to disable
+    bool resume;                   // Restore values from log_file, skip logged input values
+    const window_spec_t *window;   // Print window summaries of final results, NULL to print every result
+    const char *columnar_file;     // Columnar binary file of results, NULL to disable
+    output_format_t output_format; // Format of trace and final lines
+    bool quiet;                    // Don't print results of f(x) and g(x)
+    const char *stats_file;        // Metrics file, rewritten every second, NULL to disable
+    const char *trace_file;        // Chrome trace of value lifecycle, NULL to disable
+    int trace_sample;              // Trace one of trace_sample values, selected by hash of x
+    const char *record_prefix;     // Record results of f and g to <prefix>.f and <prefix>.g, NULL to disable
+    const char *replay_prefix;     // Replay recorded results instead of calculation, NULL to disable
+    bool replay_timed;             // Keep recorded evaluation time in replay
+    const char *virtual_clock;     // Clock file, delays of trial functions advance simulated time, NULL to sleep
+    const char *cases_file;        // Case tables of trial functions, see casegen, NULL for compiled cases
+    const char *faults;            // Fault injection of trial functions, see trial_faults_config(), NULL to disable
+    int signal_fd;                 // signalfd of SIGINT and SIGUSR1 or pipe of the same records, handled by event loop, -1 to ignore
+};
+
+/// @brief Manager configuration
+typedef struct _manager_options manager_options_t;
+
 /// @brief Initialize Inter-Process-Communication, spawn children
-/// @param input_fd    File descriptor for reading input values
-/// @param buffer_size Size of input and output buffers
-/// @param f_func      Specify f(x)
-/// @param g_func      Specify g(x)
-/// @param final_func  Specify g(x)
-manager_state_t *construct_manager(int input_fd, int buffer_size, const char *f_func, const char *g_func, const char *final_func);
+/// @param opts Manager configuration
+manager_state_t *construct_manager(const manager_options_t *opts);
 
 /// @brief Close resources, kill children
 /// @param mgr Manager allocated by construct_manager()
-void destruct_manager(manager_state_t *mgr);
+/// @return False, if results are not written
+bool destruct_manager(manager_state_t *mgr);
 
 /// @brief Send and receive data
 /// @param mgr Manager instance
@@ -42,4 +75,19 @@ bool final_calculation(manager_state_t *mgr);
 /// @param mgr Manager instance
 void shutdown(manager_state_t *mgr);
 
+/// @brief Check if operator confirmed cancellation, requested by SIGINT
+/// @param mgr Manager instance
+/// @return True, if computation should be stopped
+bool manager_cancel_confirmed(manager_state_t *mgr);
+
+/// @brief Print counters, queue state and latency histograms
+/// @param mgr    Manager instance
+/// @param stream Output stream
+void print_stats(manager_state_t *mgr, FILE *stream);
+
+/// @brief Check if all input values are received and processed
+/// @param mgr Manager instance
+/// @return True, if manager has nothing to do
+bool manager_finished(manager_state_t *mgr);
+
 #endif // __MANAGER_INC__
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <trialfuncs.h>
+
+#include "metrics.h"
+
+#define STATS_INTERVAL 1000000 // Period of stats file rewrite, microseconds
+
+static const char node_name[NODES_COUNT] = {'f', 'g'};
+
+long long metrics_now()
+{
+    // Simulated time in virtual clock mode
+    return trial_clock_usecs();
+}
+
+static int histogram_index(long long value)
+{
+    if (value < (1 << HISTOGRAM_SUB_BITS))
+    {
+        return value < 0 ? 0 : value;
+    }
+
+    if (value >= 1LL << HISTOGRAM_MAX_BITS)
+    {
+        value = (1LL << HISTOGRAM_MAX_BITS) - 1;
+    }
+
+    // Power of two selects bucket range, the next bits select linear sub-bucket
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - HISTOGRAM_SUB_BITS;
+
+    return ((shift + 1) << HISTOGRAM_SUB_BITS) + (int)(value >> shift) - (1 << HISTOGRAM_SUB_BITS);
+}
+
+/// @brief The highest value, equivalent to values of bucket
+static long long histogram_bucket_value(int index)
+{
+    if (index < (1 << HISTOGRAM_SUB_BITS))
+    {
+        return index;
+    }
+
+    int shift = (index >> HISTOGRAM_SUB_BITS) - 1;
+    long long sub = (index & ((1 << HISTOGRAM_SUB_BITS) - 1)) + (1 << HISTOGRAM_SUB_BITS);
+
+    return ((sub + 1) << shift) - 1;
+}
+
+void histogram_record(histogram_t *h, long long value)
+{
+    if (value < 0)
+    {
+        value = 0;
+    }
+
+    if (h->count == 0 || value < h->min)
+    {
+        h->min = value;
+    }
+
+    if (value > h->max)
+    {
+        h->max = value;
+    }
+
+    h->count++;
+    h->sum += value;
+    h->buckets[histogram_index(value)]++;
+}
+
+long long histogram_percentile(const histogram_t *h, double percent)
+{
+    if (h->count == 0)
+    {
+        return 0;
+    }
+
+    long long rank = (long long)(percent / 100.0 * h->count + 0.5);
+    long long seen = 0;
+
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += h->buckets[i];
+
+        if (seen >= rank)
+        {
+            long long value = histogram_bucket_value(i);
+            return value > h->max ? h->max : value;
+        }
+    }
+
+    return h->max;
+}
+
+metrics_t *construct_metrics(const char *stats_file)
+{
+    metrics_t *m = calloc(1, sizeof(metrics_t));
+
+    if (m == NULL)
+    {
+        return NULL;
+    }
+
+    m->started = metrics_now();
+    m->last_dump = m->started;
+    m->stats_file = stats_file;
+
+    return m;
+}
+
+/// @brief Replace stats file, readers never see partially written file
+static void write_stats_file(const metrics_t *m)
+{
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", m->stats_file);
+
+    FILE *stream = fopen(tmp_path, "w");
+
+    if (stream == NULL)
+    {
+        fprintf(stderr, "metrics: Failed to write %s\n", tmp_path);
+        return;
+    }
+
+    metrics_print(m, stream);
+
+    if (fclose(stream) != 0 || rename(tmp_path, m->stats_file) != 0)
+    {
+        fprintf(stderr, "metrics: Failed to replace %s\n", m->stats_file);
+    }
+}
+
+void destruct_metrics(metrics_t *m)
+{
+    if (m->stats_file != NULL)
+    {
+        write_stats_file(m);
+    }
+
+    free(m);
+}
+
+static void print_histogram(FILE *stream, const char *name, const histogram_t *h)
+{
+    fprintf(stream, "%s count %lld mean %lld min %lld p50 %lld p90 %lld p99 %lld p999 %lld max %lld\n",
+            name, h->count, h->count > 0 ? h->sum / h->count : 0, h->min,
+            histogram_percentile(h, 50), histogram_percentile(h, 90), histogram_percentile(h, 99),
+            histogram_percentile(h, 99.9), h->max);
+}
+
+void metrics_print(const metrics_t *m, FILE *stream)
+{
+    int occupied = (m->free_pos - m->head_pos + m->queue_size) % (m->queue_size > 0 ? m->queue_size : 1);
+
+    fprintf(stream, "uptime_ms %lld\n", (metrics_now() - m->started) / 1000);
+    fprintf(stream, "queue size %d head %d current %d free %d occupied %d backlog %lld\n",
+            m->queue_size, m->head_pos, m->current_pos, m->free_pos, occupied, m->backlog);
+    fprintf(stream, "input bytes %lld reads %lld\n", m->input.bytes, m->input.syscalls);
+
+    for (int i = 0; i < NODES_COUNT; i++)
+    {
+        fprintf(stream, "node %c sent %lld results %lld retries %lld hard_fails %lld pending %d in_flight %d\n",
+                node_name[i], m->values_sent[i], m->results[i], m->retries[i], m->hard_fails[i], m->pending[i], m->in_flight[i]);
+        fprintf(stream, "channel %c out_bytes %lld writes %lld in_bytes %lld reads %lld\n",
+                node_name[i], m->sent[i].bytes, m->sent[i].syscalls, m->received[i].bytes, m->received[i].syscalls);
+    }
+
+    fprintf(stream, "final count %lld failed %lld\n", m->finals, m->final_fails);
+
+    print_histogram(stream, "latency_us f", &m->node_latency[F_NODE]);
+    print_histogram(stream, "latency_us g", &m->node_latency[G_NODE]);
+    print_histogram(stream, "latency_us end_to_end", &m->end_to_end);
+    print_histogram(stream, "occupancy", &m->occupancy);
+
+    fflush(stream);
+}
+
+void metrics_tick(metrics_t *m)
+{
+    if (m->stats_file == NULL)
+    {
+        return;
+    }
+
+    long long now = metrics_now();
+
+    if (now - m->last_dump >= STATS_INTERVAL)
+    {
+        m->last_dump = now;
+        write_stats_file(m);
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef __METRICS_INC__
+#define __METRICS_INC__
+
+#include <stdio.h>
+
+#include "shared_data.h"
+
+#define HISTOGRAM_SUB_BITS 5  // Linear sub-buckets per power of two, 2^5 gives ~3% precision
+#define HISTOGRAM_MAX_BITS 40 // Recorded values are clamped below 2^40 microseconds
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+
+struct _histogram
+{
+    long long count;                      // Number of recorded values
+    long long sum;                        // Sum of recorded values
+    long long min;                        // Minimal recorded value
+    long long max;                        // Maximal recorded value
+    long long buckets[HISTOGRAM_BUCKETS]; // Log-linear buckets, as in HDR histogram
+};
+
+/// @brief Distribution of non-negative values with fixed relative precision
+typedef struct _histogram histogram_t;
+
+struct _channel_stats
+{
+    long long bytes;    // Transferred bytes
+    long long syscalls; // Number of read or write calls
+};
+
+/// @brief Traffic of single pipe
+typedef struct _channel_stats channel_stats_t;
+
+struct _metrics
+{
+    long long started;                      // Creation time, microseconds
+    long long last_dump;                    // Time of the last write of stats file, microseconds
+    const char *stats_file;                 // Periodically rewritten stats file, NULL to disable
+
+    channel_stats_t input;                  // Input stream
+    channel_stats_t sent[NODES_COUNT];      // Values sent to f and g
+    channel_stats_t received[NODES_COUNT];  // Results received from f and g
+    long long values_sent[NODES_COUNT];     // Values sent to f and g, including retries
+    long long results[NODES_COUNT];         // Results received from f and g
+    long long retries[NODES_COUNT];         // Soft fails, scheduled for retry
+    long long hard_fails[NODES_COUNT];      // Hard fails and soft fails over retry limit
+    long long finals;                       // Calculated final results
+    long long final_fails;                  // Values with failed final result
+
+    histogram_t node_latency[NODES_COUNT];  // Time from transmission of value to its result, microseconds
+    histogram_t end_to_end;                 // Time from entering the queue to final result, microseconds
+    histogram_t occupancy;                  // Number of values in queue, sampled once per cycle
+
+    // Gauges, updated by owner once per cycle
+    int queue_size;                         // Size of circular queue
+    int head_pos;                           // x_head_pos
+    int current_pos;                        // x_current_pos
+    int free_pos;                           // x_free_pos
+    int pending[NODES_COUNT];               // Values waiting for transmission to f and g
+    int in_flight[NODES_COUNT];             // Values sent to f and g, waiting for result
+    long long backlog;                      // Input values waiting for free space in queue
+};
+
+/// @brief Counters, gauges and latency histograms of manager.
+///
+/// Counters are updated directly by owner, on every system call and result.
+/// Snapshot is printed on request and periodically rewritten to stats file.
+typedef struct _metrics metrics_t;
+
+/// @brief Monotonic time
+/// @return Microseconds
+long long metrics_now();
+
+/// @brief Record value
+/// @param h     Histogram
+/// @param value Non-negative value, larger values are clamped
+void histogram_record(histogram_t *h, long long value);
+
+/// @brief Value at percentile, upper bound of bucket
+/// @param h       Histogram
+/// @param percent Percentile, 0 - 100
+/// @return Value, 0 if histogram is empty
+long long histogram_percentile(const histogram_t *h, double percent);
+
+/// @brief Create metrics
+/// @param stats_file File, rewritten every second, NULL to disable
+/// @return Metrics instance, NULL on failure
+metrics_t *construct_metrics(const char *stats_file);
+
+/// @brief Write stats file the last time, release metrics
+/// @param m Metrics allocated by construct_metrics()
+void destruct_metrics(metrics_t *m);
+
+/// @brief Print snapshot of all metrics
+/// @param m      Metrics
+/// @param stream Output stream
+void metrics_print(const metrics_t *m, FILE *stream);
+
+/// @brief Rewrite stats file, if interval is elapsed
+/// @param m Metrics
+void metrics_tick(metrics_t *m);
+
+#endif // __METRICS_INC__
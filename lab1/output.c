@@ -0,0 +1,440 @@
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/param.h>
+
+#include <compfuncs.h>
+
+#include "output.h"
+#include "registry.h"
+
+#define OUTPUT_BUFF (1 << 20) // Size of each of two buffers
+#define OUTPUT_LINE_MAX 256   // Space reserved for single formatted item
+
+struct _output_buffer
+{
+    char *data;     // Formatted lines
+    size_t len;     // Length of formatted lines
+    long long mark; // Progress mark of the last line
+};
+
+typedef struct _output_buffer output_buffer_t;
+
+struct _output
+{
+    int fd;                     // Output file descriptor
+    output_format_t format;     // Format of lines
+    bool header;                // CSV header is written
+    output_buffer_t buffers[2]; // Buffer for formatting and buffer for writer thread
+    int active;                 // Index of buffer for formatting
+    long long mark;             // Progress mark of formatted lines
+    long long handed_mark;      // Progress mark of the last buffer handed over to writer thread
+    bool pending;               // Writer thread owns the other buffer
+    bool stop;                  // Writer thread should exit
+    long long written;          // Progress mark of written lines
+    bool failed;                // Write failed, the following lines are dropped
+    pthread_t thread;           // Writer thread
+    pthread_mutex_t lock;       // Protects pending, stop, active, written and failed
+    pthread_cond_t cond;        // Signals change of pending and stop
+};
+
+static const char *format_names[OF_COUNT] = {
+    [OF_TEXT] = "text",
+    [OF_CSV] = "csv",
+    [OF_JSON] = "json",
+};
+
+static char node_name[NODES_COUNT] = {'f', 'g'};
+
+bool parse_output_format(const char *name, output_format_t *format)
+{
+    for (int i = 0; i < OF_COUNT; i++)
+    {
+        if (strcmp(name, format_names[i]) == 0)
+        {
+            *format = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool write_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t result = write(fd, data, len);
+
+        if (result == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        data += result;
+        len -= result;
+    }
+
+    return true;
+}
+
+static void *writer_thread(void *arg)
+{
+    output_t *out = arg;
+    bool failed = false;
+
+    pthread_mutex_lock(&out->lock);
+
+    while (true)
+    {
+        while (!out->pending && !out->stop)
+        {
+            pthread_cond_wait(&out->cond, &out->lock);
+        }
+
+        if (!out->pending)
+        {
+            break;
+        }
+
+        // Producer doesn't touch the other buffer, while it is pending
+        output_buffer_t *buff = &out->buffers[out->active ^ 1];
+
+        pthread_mutex_unlock(&out->lock);
+
+        if (!failed && !write_all(out->fd, buff->data, buff->len))
+        {
+            fprintf(stderr, "output: Write failed (%d)\n", errno);
+            failed = true;
+        }
+
+        pthread_mutex_lock(&out->lock);
+
+        // Lines after failure are not written, progress stays before them
+        if (failed)
+        {
+            out->failed = true;
+        }
+        else
+        {
+            out->written = buff->mark;
+        }
+        out->pending = false;
+        pthread_cond_broadcast(&out->cond);
+    }
+
+    pthread_mutex_unlock(&out->lock);
+
+    return NULL;
+}
+
+output_t *construct_output(int fd, output_format_t format)
+{
+    output_t *out = calloc(1, sizeof(output_t));
+
+    if (out == NULL)
+    {
+        return NULL;
+    }
+
+    out->fd = fd;
+    out->format = format;
+    out->buffers[0].data = malloc(OUTPUT_BUFF);
+    out->buffers[1].data = malloc(OUTPUT_BUFF);
+
+    if (out->buffers[0].data == NULL || out->buffers[1].data == NULL)
+    {
+        free(out->buffers[0].data);
+        free(out->buffers[1].data);
+        free(out);
+        return NULL;
+    }
+
+    pthread_mutex_init(&out->lock, NULL);
+    pthread_cond_init(&out->cond, NULL);
+
+    // Lines printed before, should stay before
+    fflush(stdout);
+
+    if (pthread_create(&out->thread, NULL, writer_thread, out) != 0)
+    {
+        pthread_mutex_destroy(&out->lock);
+        pthread_cond_destroy(&out->cond);
+        free(out->buffers[0].data);
+        free(out->buffers[1].data);
+        free(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+void destruct_output(output_t *out)
+{
+    output_flush(out, true);
+
+    pthread_mutex_lock(&out->lock);
+    out->stop = true;
+    pthread_cond_broadcast(&out->cond);
+    pthread_mutex_unlock(&out->lock);
+
+    pthread_join(out->thread, NULL);
+
+    pthread_mutex_destroy(&out->lock);
+    pthread_cond_destroy(&out->cond);
+    free(out->buffers[0].data);
+    free(out->buffers[1].data);
+    free(out);
+}
+
+/// @brief Give formatting buffer to writer thread, take the written one
+/// @return False, if writer thread is busy and wait is not requested
+static bool hand_over(output_t *out, bool wait)
+{
+    pthread_mutex_lock(&out->lock);
+
+    while (out->pending && wait)
+    {
+        pthread_cond_wait(&out->cond, &out->lock);
+    }
+
+    bool handed = !out->pending;
+
+    if (handed)
+    {
+        out->buffers[out->active].mark = out->mark;
+        out->handed_mark = out->mark;
+        out->active ^= 1;
+        out->pending = true;
+        pthread_cond_broadcast(&out->cond);
+    }
+
+    pthread_mutex_unlock(&out->lock);
+
+    if (handed)
+    {
+        out->buffers[out->active].len = 0;
+    }
+
+    return handed;
+}
+
+/// @brief Buffer with space for single item
+static output_buffer_t *reserve(output_t *out)
+{
+    if (OUTPUT_BUFF - out->buffers[out->active].len < OUTPUT_LINE_MAX)
+    {
+        hand_over(out, true);
+    }
+
+    return &out->buffers[out->active];
+}
+
+static void append(output_t *out, const char *fmt, ...)
+{
+    output_buffer_t *buff = reserve(out);
+    va_list args;
+
+    va_start(args, fmt);
+    int len = vsnprintf(buff->data + buff->len, OUTPUT_LINE_MAX, fmt, args);
+    va_end(args);
+
+    buff->len += MIN(len, OUTPUT_LINE_MAX - 1);
+}
+
+static void append_value(output_t *out, tf_result_t type, const value_t *val)
+{
+    // JSON has no tokens for infinity and NaN
+    if (out->format == OF_JSON && type == TFR_FLOAT && !isfinite(val->d_val))
+    {
+        append(out, "null");
+        return;
+    }
+
+    output_buffer_t *buff = reserve(out);
+    int len = result_types[type].format(buff->data + buff->len, OUTPUT_LINE_MAX, val);
+
+    buff->len += MIN(len, OUTPUT_LINE_MAX - 1);
+}
+
+static void append_csv_header(output_t *out)
+{
+    if (out->format == OF_CSV && !out->header)
+    {
+        append(out, "kind,node,function,x,status,value\n");
+        out->header = true;
+    }
+}
+
+void output_trace(output_t *out, computation_node node, trial_function_t func, int x, const value_t *val)
+{
+    bool success = val->status == COMPFUNC_SUCCESS;
+
+    switch (out->format)
+    {
+    case OF_TEXT:
+        append(out, "trial_%c_%s(%d) %s%s", node_name[node], tf_name(func), x, symbolic_status(val->status), success ? "<" : "");
+        break;
+    case OF_CSV:
+        append_csv_header(out);
+        append(out, "trial,%c,%s,%d,%s,", node_name[node], tf_name(func), x, symbolic_status(val->status));
+        break;
+    case OF_JSON:
+        append(out, "{\"kind\":\"trial\",\"node\":\"%c\",\"function\":\"%s\",\"x\":%d,\"status\":\"%s\",\"value\":%s",
+               node_name[node], tf_name(func), x, symbolic_status(val->status), success ? "" : "null");
+        break;
+    default:
+        break;
+    }
+
+    if (success)
+    {
+        append_value(out, trial_result_type(func), val);
+    }
+
+    append(out, out->format == OF_TEXT ? (success ? ">\n" : "\n") : (out->format == OF_JSON ? "}\n" : "\n"));
+}
+
+void output_retry(output_t *out, computation_node node, trial_function_t func, int x)
+{
+    switch (out->format)
+    {
+    case OF_TEXT:
+        append(out, "Retry soft fail - trial_%c_%s(%d)\n", node_name[node], tf_name(func), x);
+        break;
+    case OF_CSV:
+        append_csv_header(out);
+        append(out, "retry,%c,%s,%d,%s,\n", node_name[node], tf_name(func), x, symbolic_status(COMPFUNC_SOFT_FAIL));
+        break;
+    case OF_JSON:
+        append(out, "{\"kind\":\"retry\",\"node\":\"%c\",\"function\":\"%s\",\"x\":%d,\"status\":\"%s\"}\n",
+               node_name[node], tf_name(func), x, symbolic_status(COMPFUNC_SOFT_FAIL));
+        break;
+    default:
+        break;
+    }
+}
+
+void output_final(output_t *out, trial_function_t func, bool label, int x, const value_t *val)
+{
+    bool success = val->status == COMPFUNC_SUCCESS;
+
+    switch (out->format)
+    {
+    case OF_TEXT:
+        if (label)
+        {
+            append(out, "Final %s expression for %d %s", tf_name(func), x, success ? "" : "calculation failed");
+        }
+        else
+        {
+            append(out, "Final expression for %d %s", x, success ? "" : "calculation failed");
+        }
+        break;
+    case OF_CSV:
+        append_csv_header(out);
+        append(out, "final,,%s,%d,%s,", tf_name(func), x, symbolic_status(val->status));
+        break;
+    case OF_JSON:
+        append(out, "{\"kind\":\"final\",\"function\":\"%s\",\"x\":%d,\"status\":\"%s\",\"value\":%s",
+               tf_name(func), x, symbolic_status(val->status), success ? "" : "null");
+        break;
+    default:
+        break;
+    }
+
+    if (success)
+    {
+        append_value(out, trial_result_type(func), val);
+    }
+
+    append(out, out->format == OF_JSON ? "}\n" : "\n");
+}
+
+/// @brief Text of any length, in items of single line size
+static void append_text(output_t *out, const char *text)
+{
+    size_t len = strlen(text);
+
+    while (len > 0)
+    {
+        output_buffer_t *buff = reserve(out);
+        size_t chunk = MIN(len, OUTPUT_LINE_MAX - 1);
+
+        memcpy(buff->data + buff->len, text, chunk);
+        buff->len += chunk;
+        text += chunk;
+        len -= chunk;
+    }
+}
+
+void output_window(output_t *out, const char *summary)
+{
+    switch (out->format)
+    {
+    case OF_CSV:
+        append_csv_header(out);
+        append(out, "window,,,,,\"");
+        break;
+    case OF_JSON:
+        append(out, "{\"kind\":\"window\",\"summary\":\"");
+        break;
+    default:
+        break;
+    }
+
+    append_text(out, summary);
+    append(out, out->format == OF_TEXT ? "\n" : (out->format == OF_JSON ? "\"}\n" : "\"\n"));
+}
+
+void output_mark(output_t *out, long long mark)
+{
+    out->mark = mark;
+}
+
+long long output_written(output_t *out)
+{
+    pthread_mutex_lock(&out->lock);
+    long long written = out->written;
+    pthread_mutex_unlock(&out->lock);
+
+    return written;
+}
+
+bool output_failed(output_t *out)
+{
+    pthread_mutex_lock(&out->lock);
+    bool failed = out->failed;
+    pthread_mutex_unlock(&out->lock);
+
+    return failed;
+}
+
+void output_flush(output_t *out, bool wait)
+{
+    if (out->buffers[out->active].len > 0 || out->mark != out->handed_mark)
+    {
+        hand_over(out, wait);
+    }
+
+    if (wait)
+    {
+        pthread_mutex_lock(&out->lock);
+
+        while (out->pending)
+        {
+            pthread_cond_wait(&out->cond, &out->lock);
+        }
+
+        pthread_mutex_unlock(&out->lock);
+    }
+}
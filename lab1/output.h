@@ -0,0 +1,89 @@
+#ifndef __OUTPUT_INC__
+#define __OUTPUT_INC__
+
+#include <stdbool.h>
+
+#include "shared_data.h"
+
+enum _output_format
+{
+    OF_TEXT, // Human readable lines, as printed before
+    OF_CSV,  // kind,node,function,x,status,value
+    OF_JSON, // JSON object per line
+    OF_COUNT
+};
+
+/// @brief Format of trace and final lines
+typedef enum _output_format output_format_t;
+
+/// @brief Asynchronous output of results.
+///
+/// Lines are formatted into large buffer on dispatch thread, filled buffer is
+/// handed over to writer thread. Dispatch thread waits only if writer thread
+/// is still busy with the previous buffer, when the current one is full.
+typedef struct _output output_t;
+
+/// @brief Find format by name
+/// @param name   Format name - text, csv or json
+/// @param format Found format
+/// @return True, if format is known
+bool parse_output_format(const char *name, output_format_t *format);
+
+/// @brief Start writer thread
+/// @param fd     Output file descriptor
+/// @param format Format of lines
+/// @return Output instance, NULL on failure
+output_t *construct_output(int fd, output_format_t format);
+
+/// @brief Write buffered lines, stop writer thread
+/// @param out Output allocated by construct_output()
+void destruct_output(output_t *out);
+
+/// @brief Result of trial function
+/// @param out  Output
+/// @param node Computation node
+/// @param func Trial function
+/// @param x    Input value
+/// @param val  Result
+void output_trace(output_t *out, computation_node node, trial_function_t func, int x, const value_t *val);
+
+/// @brief Soft fail is going to be calculated again
+/// @param out  Output
+/// @param node Computation node
+/// @param func Trial function
+/// @param x    Input value
+void output_retry(output_t *out, computation_node node, trial_function_t func, int x);
+
+/// @brief Result of final operation
+/// @param out   Output
+/// @param func  Final operation
+/// @param label Name operation in text output, when several operations are evaluated
+/// @param x     Input value
+/// @param val   Result
+void output_final(output_t *out, trial_function_t func, bool label, int x, const value_t *val);
+
+/// @brief Summary of window of final results
+/// @param out     Output
+/// @param summary Text of summary, without new line
+void output_window(output_t *out, const char *summary);
+
+/// @brief Attach progress mark to buffered lines
+/// @param out  Output
+/// @param mark Number of values, which lines are buffered
+void output_mark(output_t *out, long long mark);
+
+/// @brief Progress mark of lines, which are written already
+/// @param out Output
+long long output_written(output_t *out);
+
+/// @brief Check if writer thread failed to write lines
+/// @param out Output
+/// @return True, if lines are lost, progress mark of written lines doesn't advance
+bool output_failed(output_t *out);
+
+/// @brief Hand over buffered lines to writer thread
+/// @param out  Output
+/// @param wait Wait until all lines are written, otherwise skip if writer thread is busy
+void output_flush(output_t *out, bool wait);
+
+#endif // __OUTPUT_INC__
@@ -0,0 +1,169 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "record.h"
+
+#define RECORD_MAGIC "L125REC1"
+
+struct _record_header
+{
+    char magic[8]; // RECORD_MAGIC
+    uint8_t node;  // Recorded node
+    uint8_t pad[7];
+    char func[16]; // Trial function name
+};
+
+typedef struct _record_header record_header_t;
+
+struct _recorder
+{
+    FILE *file; // Recording file, buffered by stdio
+};
+
+recorder_t *construct_recorder(const char *path, computation_node node, const char *func)
+{
+    recorder_t *rec = malloc(sizeof(recorder_t));
+
+    if (rec == NULL)
+    {
+        return NULL;
+    }
+
+    rec->file = fopen(path, "wb");
+
+    if (rec->file == NULL)
+    {
+        free(rec);
+        return NULL;
+    }
+
+    record_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RECORD_MAGIC, sizeof(header.magic));
+    header.node = node;
+    strncpy(header.func, func, sizeof(header.func) - 1);
+
+    if (fwrite(&header, sizeof(header), 1, rec->file) != 1)
+    {
+        fclose(rec->file);
+        free(rec);
+        return NULL;
+    }
+
+    return rec;
+}
+
+void destruct_recorder(recorder_t *rec)
+{
+    fclose(rec->file);
+    free(rec);
+}
+
+bool record_results(recorder_t *rec, const int *xs, const value_t *results, int count, long long eval_us)
+{
+    for (int i = 0; i < count; i++)
+    {
+        record_entry_t entry;
+
+        memset(&entry, 0, sizeof(entry));
+        entry.x = xs[i];
+        entry.eval_us = eval_us / count;
+        entry.value = results[i];
+
+        if (fwrite(&entry, sizeof(entry), 1, rec->file) != 1)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// @brief Read and validate header
+static bool read_header(FILE *file, const char *path, record_header_t *header)
+{
+    if (fread(header, sizeof(*header), 1, file) != 1 || memcmp(header->magic, RECORD_MAGIC, sizeof(header->magic)) != 0 || header->node >= NODES_COUNT)
+    {
+        fprintf(stderr, "record: Invalid recording %s\n", path);
+        return false;
+    }
+
+    header->func[sizeof(header->func) - 1] = '\0';
+
+    return true;
+}
+
+bool check_recording(const char *path, computation_node node, const char *func)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "record: Failed to open %s\n", path);
+        return false;
+    }
+
+    record_header_t header;
+    bool valid = read_header(file, path, &header);
+
+    fclose(file);
+
+    if (valid && (header.node != node || strcmp(header.func, func) != 0))
+    {
+        fprintf(stderr, "record: %s is made for %s node, %s function\n", path, header.node == F_NODE ? "f" : "g", header.func);
+        valid = false;
+    }
+
+    return valid;
+}
+
+bool load_recording(const char *path, recording_t *rec)
+{
+    memset(rec, 0, sizeof(*rec));
+
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    record_header_t header;
+
+    if (!read_header(file, path, &header))
+    {
+        fclose(file);
+        return false;
+    }
+
+    rec->node = header.node;
+    memcpy(rec->func, header.func, sizeof(rec->func));
+
+    // Incomplete trailing entry is dropped
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rec->count = (size - (long)sizeof(header)) / sizeof(record_entry_t);
+    fseek(file, sizeof(header), SEEK_SET);
+
+    rec->entries = malloc(sizeof(record_entry_t) * (rec->count > 0 ? rec->count : 1));
+
+    bool loaded = rec->entries != NULL && fread(rec->entries, sizeof(record_entry_t), rec->count, file) == (size_t)rec->count;
+
+    fclose(file);
+
+    if (!loaded)
+    {
+        free_recording(rec);
+    }
+
+    return loaded;
+}
+
+void free_recording(recording_t *rec)
+{
+    free(rec->entries);
+    rec->entries = NULL;
+    rec->count = 0;
+}
@@ -0,0 +1,73 @@
+#ifndef __RECORD_INC__
+#define __RECORD_INC__
+
+#include <stdbool.h>
+
+#include "shared_data.h"
+
+/// @brief Recording of results stream of single computation node.
+///
+/// Every result, sent by calculon, is stored with its input value and evaluation
+/// time, in order of transmission. Replay worker answers the same input stream
+/// with recorded results, without evaluation of trial function.
+typedef struct _recorder recorder_t;
+
+struct _record_entry
+{
+    int x;                // Input value
+    unsigned int eval_us; // Evaluation time, share of the batch
+    value_t value;        // Result, as sent to manager
+};
+
+/// @brief Recorded result
+typedef struct _record_entry record_entry_t;
+
+struct _recording
+{
+    computation_node node;   // Recorded node
+    char func[16];           // Recorded trial function
+    record_entry_t *entries; // Results, in order of transmission
+    long long count;         // Number of results
+};
+
+/// @brief Results stream, loaded from file
+typedef struct _recording recording_t;
+
+/// @brief Create recording file
+/// @param path Recording file
+/// @param node Recorded node
+/// @param func Trial function name
+/// @return Recorder instance, NULL on failure
+recorder_t *construct_recorder(const char *path, computation_node node, const char *func);
+
+/// @brief Write buffered results, close file
+/// @param rec Recorder allocated by construct_recorder()
+void destruct_recorder(recorder_t *rec);
+
+/// @brief Record batch of results
+/// @param rec     Recorder
+/// @param xs      Input values
+/// @param results Results
+/// @param count   Number of results
+/// @param eval_us Evaluation time of the whole batch, microseconds
+/// @return True, on success
+bool record_results(recorder_t *rec, const int *xs, const value_t *results, int count, long long eval_us);
+
+/// @brief Check header of recording file
+/// @param path Recording file
+/// @param node Expected node
+/// @param func Expected trial function
+/// @return True, if recording is made for node and function
+bool check_recording(const char *path, computation_node node, const char *func);
+
+/// @brief Load recording file
+/// @param path Recording file
+/// @param rec  Loaded results
+/// @return True, on success
+bool load_recording(const char *path, recording_t *rec);
+
+/// @brief Release loaded results
+/// @param rec Recording filled by load_recording()
+void free_recording(recording_t *rec);
+
+#endif // __RECORD_INC__
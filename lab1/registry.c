@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include <trialfuncs.h>
+
+#include "registry.h"
+
+// Value types - X(type id, C type, TYPESTR() of trialfuncs, value_t member)
+#define FOREACH_RESULT_TYPE(X)                      \
+    X(TFR_INT, int, int, i_val)                     \
+    X(TFR_UINT, unsigned int, unsigned_int, ui_val) \
+    X(TFR_FLOAT, double, double, d_val)             \
+    X(TFR_BOOL, bool, _Bool, b_val)
+
+// Cast destinations for the given source type, same list as FOREACH_RESULT_TYPE()
+#define FOREACH_CAST_TO(X, ...)                                  \
+    X(__VA_ARGS__, TFR_INT, int, int, i_val)                     \
+    X(__VA_ARGS__, TFR_UINT, unsigned int, unsigned_int, ui_val) \
+    X(__VA_ARGS__, TFR_FLOAT, double, double, d_val)             \
+    X(__VA_ARGS__, TFR_BOOL, bool, _Bool, b_val)
+
+//
+// Value types
+//
+
+// Formatting to buffer, the same output as print_<type>_value() of trialfuncs
+#define FORMAT_int(buff, size, value) snprintf(buff, size, "%d", value)
+#define FORMAT_unsigned_int(buff, size, value) snprintf(buff, size, "%d", value)
+#define FORMAT_double(buff, size, value) snprintf(buff, size, "%lf", value)
+#define FORMAT__Bool(buff, size, value) snprintf(buff, size, "%s", (value) ? "true" : "false")
+
+#define DEFINE_TYPE_OPS(TFR, c_type, typestr, field)                              \
+    static void store_##typestr(value_column_t *col, int pos, const value_t *val) \
+    {                                                                             \
+        col->status[pos] = val->status;                                           \
+        /* Failed values are zeroed, final kernels combine them without branches */ \
+        col->field[pos] = val->status == COMPFUNC_SUCCESS ? val->field : 0;       \
+    }                                                                             \
+                                                                                  \
+    static void load_##typestr(const value_column_t *col, int pos, value_t *val)  \
+    {                                                                             \
+        memset(val, 0, sizeof(*val));                                             \
+        val->status = col->status[pos];                                           \
+        val->field = col->field[pos];                                             \
+    }                                                                             \
+                                                                                  \
+    static void print_##typestr(const value_t *val)                               \
+    {                                                                             \
+        PRINT_VALUE(typestr, val->field);                                         \
+    }                                                                             \
+                                                                                  \
+    static int format_##typestr(char *buff, size_t size, const value_t *val)      \
+    {                                                                             \
+        return FORMAT_##typestr(buff, size, val->field);                          \
+    }
+
+FOREACH_RESULT_TYPE(DEFINE_TYPE_OPS)
+
+#define TYPE_OPS_ENTRY(TFR, c_type, typestr, field) \
+    [TFR] = {#c_type, sizeof(c_type), store_##typestr, load_##typestr, print_##typestr, format_##typestr},
+
+const result_type_ops_t result_types[TFR_COUNT] = {
+    FOREACH_RESULT_TYPE(TYPE_OPS_ENTRY)
+};
+
+//
+// Cast kernels, element-wise conversion loops are vectorized by compiler
+//
+
+#define DEFINE_CAST(FROM, from_type, from_str, from_field, TO, to_type, to_str, to_field)                      \
+    static void cast_##from_str##_to_##to_str(const value_column_t *src, value_column_t *dst, int begin, int count) \
+    {                                                                                                           \
+        memcpy(dst->status + begin, src->status + begin, count);                                                \
+                                                                                                                \
+        to_type *restrict d = dst->to_field + begin;                                                            \
+        const from_type *restrict s = src->from_field + begin;                                                  \
+        for (int i = 0; i < count; i++)                                                                         \
+        {                                                                                                       \
+            d[i] = s[i];                                                                                        \
+        }                                                                                                       \
+    }
+
+#define DEFINE_CASTS_FROM(...) FOREACH_CAST_TO(DEFINE_CAST, __VA_ARGS__)
+
+FOREACH_RESULT_TYPE(DEFINE_CASTS_FROM)
+
+#define CAST_ENTRY(FROM, from_type, from_str, from_field, TO, to_type, to_str, to_field) \
+    [FROM][TO] = cast_##from_str##_to_##to_str,
+
+#define CAST_ENTRIES_FROM(...) FOREACH_CAST_TO(CAST_ENTRY, __VA_ARGS__)
+
+const column_cast_func_t column_casts[TFR_COUNT][TFR_COUNT] = {
+    FOREACH_RESULT_TYPE(CAST_ENTRIES_FROM)
+};
+
+//
+// Evaluation, wraps batch trial functions of the library
+//
+
+#define DEFINE_EVAL(name, op)                                                                      \
+    static int eval_##name##_##op(const int *xs, int count, value_t *results)                      \
+    {                                                                                              \
+        TYPE(op) values[EVAL_BATCH_MAX];                                                           \
+        compfunc_status_t statuses[EVAL_BATCH_MAX];                                                \
+                                                                                                   \
+        int done = name##_##op##_batch(xs, MIN(count, EVAL_BATCH_MAX), values, statuses);          \
+                                                                                                   \
+        memset(results, 0, sizeof(value_t) * done);                                                \
+        for (int i = 0; i < done; i++)                                                             \
+        {                                                                                          \
+            results[i].status = statuses[i];                                                       \
+            if (statuses[i] == COMPFUNC_SUCCESS)                                                   \
+            {                                                                                      \
+                results[i].VALUE_FIELD(TYPESTR(op)) = values[i];                                   \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return done;                                                                               \
+    }
+
+#define DEFINE_OP_EVAL(op, OP) \
+    DEFINE_EVAL(trial_f, op)   \
+    DEFINE_EVAL(trial_g, op)
+
+FOREACH_TRIAL_OP(DEFINE_OP_EVAL)
+
+//
+// Final operation kernels, one per operation of FOREACH_TRIAL_OP()
+//
+
+#define IMUL_EXPR(a, b) ((int)((unsigned int)(a) * (unsigned int)(b))) // Wrap around on overflow
+#define FMUL_EXPR(a, b) ((a) * (b))
+
+/// @brief Numeric operation, fails if any argument failed
+#define DEFINE_NUMERIC_FINAL(op, expr)                                                                                \
+    static void final_##op(const value_column_t *arg1, const value_column_t *arg2, value_column_t *result, int begin, int count) \
+    {                                                                                                                 \
+        const unsigned char *restrict s1 = arg1->status + begin;                                                      \
+        const unsigned char *restrict s2 = arg2->status + begin;                                                      \
+        const TYPE(op) *restrict v1 = arg1->VALUE_FIELD(TYPESTR(op)) + begin;                                         \
+        const TYPE(op) *restrict v2 = arg2->VALUE_FIELD(TYPESTR(op)) + begin;                                         \
+        unsigned char *restrict rs = result->status + begin;                                                          \
+        TYPE(op) *restrict rv = result->VALUE_FIELD(TYPESTR(op)) + begin;                                             \
+                                                                                                                      \
+        for (int i = 0; i < count; i++)                                                                               \
+        {                                                                                                             \
+            rs[i] = (s1[i] | s2[i]) ? COMPFUNC_HARD_FAIL : COMPFUNC_SUCCESS;                                          \
+            rv[i] = expr(v1[i], v2[i]);                                                                               \
+        }                                                                                                             \
+    }
+
+DEFINE_NUMERIC_FINAL(imul, IMUL_EXPR)
+DEFINE_NUMERIC_FINAL(imin, MIN)
+DEFINE_NUMERIC_FINAL(fmul, FMUL_EXPR)
+DEFINE_NUMERIC_FINAL(fmin, MIN)
+
+static void final_and(const value_column_t *arg1, const value_column_t *arg2, value_column_t *result, int begin, int count)
+{
+    const unsigned char *restrict s1 = arg1->status + begin;
+    const unsigned char *restrict s2 = arg2->status + begin;
+    const bool *restrict v1 = arg1->b_val + begin;
+    const bool *restrict v2 = arg2->b_val + begin;
+    unsigned char *restrict rs = result->status + begin;
+    bool *restrict rv = result->b_val + begin;
+
+    for (int i = 0; i < count; i++)
+    {
+        bool ok1 = s1[i] == COMPFUNC_SUCCESS;
+        bool ok2 = s2[i] == COMPFUNC_SUCCESS;
+        // False if one of args is False, failed values are zeroed
+        bool ok = (ok1 & ok2) | (ok1 & !v1[i]) | (ok2 & !v2[i]);
+        rs[i] = ok ? COMPFUNC_SUCCESS : COMPFUNC_HARD_FAIL;
+        rv[i] = v1[i] & v2[i];
+    }
+}
+
+static void final_or(const value_column_t *arg1, const value_column_t *arg2, value_column_t *result, int begin, int count)
+{
+    const unsigned char *restrict s1 = arg1->status + begin;
+    const unsigned char *restrict s2 = arg2->status + begin;
+    const bool *restrict v1 = arg1->b_val + begin;
+    const bool *restrict v2 = arg2->b_val + begin;
+    unsigned char *restrict rs = result->status + begin;
+    bool *restrict rv = result->b_val + begin;
+
+    for (int i = 0; i < count; i++)
+    {
+        bool ok1 = s1[i] == COMPFUNC_SUCCESS;
+        bool ok2 = s2[i] == COMPFUNC_SUCCESS;
+        // True if one of args is True, failed values are zeroed
+        bool ok = (ok1 & ok2) | (ok1 & v1[i]) | (ok2 & v2[i]);
+        rs[i] = ok ? COMPFUNC_SUCCESS : COMPFUNC_HARD_FAIL;
+        rv[i] = v1[i] | v2[i];
+    }
+}
+
+//
+// Operations registry
+//
+
+#define OP_ENTRY(op, OP)                                                    \
+    [TF_##OP] = {                                                           \
+        .name = #op,                                                        \
+        .result_type = RESULT_TYPE(TYPESTR(op)),                            \
+        .eval = {[F_NODE] = eval_trial_f_##op, [G_NODE] = eval_trial_g_##op}, \
+        .final = final_##op,                                                \
+    },
+
+const trial_op_t trial_ops[TF_COUNT] = {
+    FOREACH_TRIAL_OP(OP_ENTRY)
+};
@@ -0,0 +1,64 @@
+#ifndef __REGISTRY_INC__
+#define __REGISTRY_INC__
+
+#include <stddef.h>
+
+#include "result_store.h"
+#include "shared_data.h"
+
+/// @brief Maximal number of values evaluated by single eval_batch_func_t call
+#define EVAL_BATCH_MAX 256
+
+/// @brief Evaluate trial function for array of x values
+/// @return Number of evaluated values, results are packed for data interchange
+typedef int (*eval_batch_func_t)(const int *xs, int count, value_t *results);
+
+/// @brief Convert range of column values to the type of destination column
+typedef void (*column_cast_func_t)(const value_column_t *src, value_column_t *dst, int begin, int count);
+
+/// @brief Apply final operation to the range of values, operands have result type of operation
+typedef void (*final_op_func_t)(const value_column_t *arg1, const value_column_t *arg2, value_column_t *result, int begin, int count);
+
+struct _trial_op
+{
+    const char *name;                    // Operation name, as accepted from command line
+    tf_result_t result_type;             // Type of results
+    eval_batch_func_t eval[NODES_COUNT]; // f(x) and g(x) implementations
+    final_op_func_t final;               // Final operation kernel
+};
+
+/// @brief Registry entry of trial function / final operation
+typedef struct _trial_op trial_op_t;
+
+struct _result_type_ops
+{
+    const char *name; // Type name
+    size_t size;      // Size of payload in column
+
+    /// @brief Store value, failed values are zeroed
+    void (*store)(value_column_t *col, int pos, const value_t *val);
+
+    /// @brief Load value from column
+    void (*load)(const value_column_t *col, int pos, value_t *val);
+
+    /// @brief Print payload, with print_<type>_value() of trialfuncs
+    void (*print)(const value_t *val);
+
+    /// @brief Format payload to buffer, like print()
+    /// @return Number of characters, as snprintf()
+    int (*format)(char *buff, size_t size, const value_t *val);
+};
+
+/// @brief Registry entry of value type
+typedef struct _result_type_ops result_type_ops_t;
+
+/// @brief All operations, generated from FOREACH_TRIAL_OP(), indexed by trial_function_t
+extern const trial_op_t trial_ops[TF_COUNT];
+
+/// @brief Value types, indexed by tf_result_t
+extern const result_type_ops_t result_types[TFR_COUNT];
+
+/// @brief Cast kernels, indexed by source and destination types
+extern const column_cast_func_t column_casts[TFR_COUNT][TFR_COUNT];
+
+#endif // __REGISTRY_INC__
@@ -0,0 +1,250 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <time.h>
+
+#include "record.h"
+#include "registry.h"
+#include "shared_data.h"
+
+struct _replay_key
+{
+    int x;           // Input value
+    long long entry; // Index of recorded result
+};
+
+/// @brief Recorded result, ordered by input value and position in recording
+typedef struct _replay_key replay_key_t;
+
+struct _replay_index
+{
+    replay_key_t *keys; // Recorded results, sorted by x, the same x in order of recording
+    long long *used;    // Served results of x, stored at the first key of x
+    long long count;    // Number of keys
+};
+
+/// @brief Results of recording by input value, input order may differ from recorded one
+typedef struct _replay_index replay_index_t;
+
+void handle_interrupt()
+{
+    // Bypass, handled by parent process
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+    const replay_key_t *ka = a;
+    const replay_key_t *kb = b;
+
+    if (ka->x != kb->x)
+    {
+        return ka->x < kb->x ? -1 : 1;
+    }
+
+    return ka->entry < kb->entry ? -1 : (ka->entry > kb->entry ? 1 : 0);
+}
+
+static bool construct_replay_index(const recording_t *rec, replay_index_t *index)
+{
+    index->count = rec->count;
+    index->keys = malloc(sizeof(replay_key_t) * (rec->count + 1));
+    index->used = calloc(rec->count + 1, sizeof(long long));
+
+    if (index->keys == NULL || index->used == NULL)
+    {
+        free(index->keys);
+        free(index->used);
+        return false;
+    }
+
+    for (long long i = 0; i < rec->count; i++)
+    {
+        index->keys[i].x = rec->entries[i].x;
+        index->keys[i].entry = i;
+    }
+
+    qsort(index->keys, index->count, sizeof(replay_key_t), compare_keys);
+
+    return true;
+}
+
+static void destruct_replay_index(replay_index_t *index)
+{
+    free(index->keys);
+    free(index->used);
+}
+
+/// @brief The next unused result of x - repeated x gets its recorded results in order
+/// @return Index of recorded result, -1 if x is not recorded or its results are used up
+static long long replay_lookup(replay_index_t *index, int x)
+{
+    long long low = 0;
+    long long high = index->count;
+
+    // The first key of x
+    while (low < high)
+    {
+        long long mid = low + (high - low) / 2;
+
+        if (index->keys[mid].x < x)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    long long next = low + index->used[low];
+
+    if (next >= index->count || index->keys[next].x != x)
+    {
+        return -1;
+    }
+
+    index->used[low]++;
+
+    return index->keys[next].entry;
+}
+
+/// @brief Stand-in for calculon, answers with recorded results instead of evaluation
+int main(int argc, char **argv)
+{
+    bool timed = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "T")) != -1)
+    {
+        switch (opt)
+        {
+        case 'T':
+            timed = true;
+            break;
+        default:
+            argc = 0;
+            break;
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc != 3 && argc != 5)
+    {
+        fprintf(stdout, "Usage: replayon [-T] <record_file> <f or g> <function> [<x_pipe> <result_pipe>]\n"
+                        "  -T  keep recorded evaluation time, otherwise results are sent at full speed\n");
+        return 1;
+    }
+
+    recording_t rec;
+
+    if (!load_recording(argv[0], &rec))
+    {
+        fprintf(stderr, "Failed to load recording - %s\n", argv[0]);
+        return 1;
+    }
+
+    computation_node node = strcmp("f", argv[1]) == 0 ? F_NODE : (strcmp("g", argv[1]) == 0 ? G_NODE : NODES_COUNT);
+
+    if (node != rec.node || strcmp(argv[2], rec.func) != 0)
+    {
+        fprintf(stderr, "Recording %s is made for %s node, %s function\n", argv[0], rec.node == F_NODE ? "f" : "g", rec.func);
+        return 1;
+    }
+
+    replay_index_t index;
+
+    if (!construct_replay_index(&rec, &index))
+    {
+        fprintf(stderr, "Failed to index recording - %s\n", argv[0]);
+        return 1;
+    }
+
+    const char *x_pipe = argc == 5 ? argv[3] : node_pipe[node][0];
+    const char *result_pipe = argc == 5 ? argv[4] : node_pipe[node][1];
+
+    int comm_fd = open(x_pipe, O_RDONLY);
+    if (comm_fd == -1)
+    {
+        fprintf(stderr, "Failed to open input named pipe - %s\n", x_pipe);
+        return 1;
+    }
+
+    int result_fd = open(result_pipe, O_WRONLY);
+    if (result_fd == -1)
+    {
+        fprintf(stderr, "Failed to open result named pipe - %s\n", result_pipe);
+        return 1;
+    }
+
+    // Process interrupt is handled by parent
+    signal(SIGINT, handle_interrupt);
+
+    long long mismatches = 0; // Input values, which are not recorded or repeated more times than recorded
+
+    // Batch of results fits PIPE_BUF, as in calculon
+    int buff[EVAL_BATCH_MAX];
+    value_t results[EVAL_BATCH_MAX];
+    while (1)
+    {
+        int retval = read(comm_fd, buff, sizeof(buff));
+        if (retval == -1)
+        {
+            fprintf(stderr, "NODE %d: Data error\n", node);
+            return 1;
+        }
+        else if (retval == 0)
+        {
+            break;
+        }
+
+        int count = retval / sizeof(int);
+        long long eval_us = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            // Input values may come in other order, e.g. retries or several clients of daemon
+            long long entry = replay_lookup(&index, buff[i]);
+
+            if (entry != -1)
+            {
+                results[i] = rec.entries[entry].value;
+                eval_us += rec.entries[entry].eval_us;
+            }
+            else
+            {
+                memset(&results[i], 0, sizeof(results[i]));
+                results[i].status = COMPFUNC_HARD_FAIL;
+                mismatches++;
+            }
+        }
+
+        if (timed && eval_us > 0)
+        {
+            struct timespec delay = {eval_us / 1000000, (eval_us % 1000000) * 1000};
+            nanosleep(&delay, NULL);
+        }
+
+        int w_result = write(result_fd, results, sizeof(value_t) * count);
+        if (w_result != sizeof(value_t) * count)
+        {
+            fprintf(stderr, "NODE %d: Data write error (%d)\n", node, w_result);
+            return 1;
+        }
+    }
+
+    if (mismatches > 0)
+    {
+        fprintf(stderr, "NODE %d: %lld input values are not in recording, answered as hard fails\n", node, mismatches);
+    }
+
+    destruct_replay_index(&index);
+    free_recording(&rec);
+
+    return 0;
+}
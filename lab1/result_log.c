@@ -0,0 +1,311 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "result_log.h"
+
+#define LOG_MAGIC "L125WAL2"
+#define LOG_BUFF 2048            // Records buffered before write
+#define LOG_SYNC_INTERVAL_MS 200 // Minimal interval between fsync calls
+#define LOG_FUNCS_MAX 64         // Space for name of function or list of final operations
+
+enum _log_record_type
+{
+    LR_INPUT,
+    LR_RESULT,
+    LR_PRINTED,
+};
+
+struct _log_header
+{
+    char magic[8];      // LOG_MAGIC
+    char funcs[3][LOG_FUNCS_MAX]; // f(x), g(x) and final operation names, zero terminated
+};
+
+typedef struct _log_header log_header_t;
+
+struct _log_record
+{
+    uint8_t type;   // enum _log_record_type
+    uint8_t node;   // Computation node of LR_RESULT
+    uint8_t pad[2];
+    int32_t x;      // Input value of LR_INPUT
+    int64_t seq;    // Sequence number of input value
+    value_t value;  // Result of LR_RESULT
+};
+
+typedef struct _log_record log_record_t;
+
+struct _result_log
+{
+    int fd;                         // Log file
+    log_record_t buff[LOG_BUFF];    // Records waiting for write
+    int count;                      // Number of buffered records
+    long long printed;              // The first value which is not printed
+    long long printed_logged;       // Last printed value in log
+    struct timespec last_sync;      // Time of last fsync
+    bool dirty;                     // Records written after last fsync
+};
+
+/// @return False, if name doesn't fit header, it is not cut to keep logs of different operations apart
+static bool fill_header(log_header_t *header, const char *const funcs[3])
+{
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, LOG_MAGIC, sizeof(header->magic));
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (strlen(funcs[i]) >= sizeof(header->funcs[i]))
+        {
+            fprintf(stderr, "log: Name %s is longer than %d characters\n", funcs[i], LOG_FUNCS_MAX - 1);
+            return false;
+        }
+
+        strcpy(header->funcs[i], funcs[i]);
+    }
+
+    return true;
+}
+
+result_log_t *construct_result_log(const char *path, const char *const funcs[3], bool append)
+{
+    log_header_t header;
+
+    if (!fill_header(&header, funcs))
+    {
+        return NULL;
+    }
+
+    result_log_t *log = calloc(1, sizeof(result_log_t));
+
+    if (log == NULL)
+    {
+        return NULL;
+    }
+
+    log->fd = open(path, O_WRONLY | O_CREAT | (append ? 0 : O_TRUNC), 0640);
+    if (log->fd == -1)
+    {
+        free(log);
+        return NULL;
+    }
+
+    off_t size = lseek(log->fd, 0, SEEK_END);
+
+    if (size < (off_t)sizeof(log_header_t))
+    {
+        // New log
+        if (ftruncate(log->fd, 0) == -1 || pwrite(log->fd, &header, sizeof(header), 0) != sizeof(header))
+        {
+            close(log->fd);
+            free(log);
+            return NULL;
+        }
+        size = sizeof(header);
+    }
+    else
+    {
+        // Drop torn record, written partially before interruption
+        size -= (size - sizeof(log_header_t)) % sizeof(log_record_t);
+        if (ftruncate(log->fd, size) == -1)
+        {
+            close(log->fd);
+            free(log);
+            return NULL;
+        }
+    }
+
+    lseek(log->fd, size, SEEK_SET);
+    clock_gettime(CLOCK_MONOTONIC, &log->last_sync);
+
+    return log;
+}
+
+void destruct_result_log(result_log_t *log)
+{
+    flush_result_log(log);
+    fsync(log->fd);
+    close(log->fd);
+    free(log);
+}
+
+static void append_record(result_log_t *log, const log_record_t *record)
+{
+    if (log->count == LOG_BUFF)
+    {
+        flush_result_log(log);
+    }
+
+    log->buff[log->count++] = *record;
+}
+
+void log_input(result_log_t *log, long long seq, int x)
+{
+    log_record_t record = {.type = LR_INPUT, .x = x, .seq = seq};
+    append_record(log, &record);
+}
+
+void log_result(result_log_t *log, long long seq, computation_node node, const value_t *value)
+{
+    log_record_t record = {.type = LR_RESULT, .node = node, .seq = seq, .value = *value};
+    append_record(log, &record);
+}
+
+void log_printed(result_log_t *log, long long seq)
+{
+    log->printed = seq;
+}
+
+bool flush_result_log(result_log_t *log)
+{
+    if (log->printed != log->printed_logged)
+    {
+        // Printed values must reach output before the mark reaches log
+        fflush(stdout);
+
+        log_record_t record = {.type = LR_PRINTED, .seq = log->printed};
+        log->printed_logged = log->printed;
+
+        if (log->count == LOG_BUFF)
+        {
+            flush_result_log(log);
+        }
+        log->buff[log->count++] = record;
+    }
+
+    if (log->count > 0)
+    {
+        ssize_t size = sizeof(log_record_t) * log->count;
+        if (write(log->fd, log->buff, size) != size)
+        {
+            return false;
+        }
+        log->count = 0;
+        log->dirty = true;
+    }
+
+    if (log->dirty)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        long long elapsed_ms = (now.tv_sec - log->last_sync.tv_sec) * 1000 + (now.tv_nsec - log->last_sync.tv_nsec) / 1000000;
+        if (elapsed_ms >= LOG_SYNC_INTERVAL_MS)
+        {
+            fdatasync(log->fd);
+            log->last_sync = now;
+            log->dirty = false;
+        }
+    }
+
+    return true;
+}
+
+bool result_log_replay(const char *path, const char *const funcs[3], log_replay_t *replay)
+{
+    memset(replay, 0, sizeof(*replay));
+
+    log_header_t header;
+
+    if (!fill_header(&header, funcs))
+    {
+        return false;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        // Nothing to resume
+        return true;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return false;
+    }
+
+    if (st.st_size < (off_t)sizeof(log_header_t))
+    {
+        close(fd);
+        return true;
+    }
+
+    const char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    if (memcmp(map, &header, sizeof(header)) != 0)
+    {
+        fprintf(stderr, "manager: Log %s is written for other functions\n", path);
+        munmap((void *)map, st.st_size);
+        return false;
+    }
+
+    const log_record_t *records = (const log_record_t *)(map + sizeof(log_header_t));
+    long long count = (st.st_size - sizeof(log_header_t)) / sizeof(log_record_t);
+
+    // Find printed and logged ranges at first
+    for (long long i = 0; i < count; i++)
+    {
+        if (records[i].type == LR_INPUT && records[i].seq >= replay->inputs)
+        {
+            replay->inputs = records[i].seq + 1;
+        }
+        else if (records[i].type == LR_PRINTED && records[i].seq > replay->first_seq)
+        {
+            replay->first_seq = records[i].seq;
+        }
+    }
+
+    replay->count = replay->inputs - replay->first_seq;
+    replay->entries = calloc(replay->count > 0 ? replay->count : 1, sizeof(log_entry_t));
+
+    if (replay->entries == NULL)
+    {
+        munmap((void *)map, st.st_size);
+        return false;
+    }
+
+    // Restore values which are not printed
+    for (long long i = 0; i < count; i++)
+    {
+        long long index = records[i].seq - replay->first_seq;
+
+        if (index < 0 || index >= replay->count)
+        {
+            continue;
+        }
+
+        if (records[i].type == LR_INPUT)
+        {
+            replay->entries[index].x = records[i].x;
+        }
+        else if (records[i].type == LR_RESULT && records[i].node < NODES_COUNT)
+        {
+            replay->entries[index].known |= 1 << records[i].node;
+            replay->entries[index].result[records[i].node] = records[i].value;
+        }
+    }
+
+    munmap((void *)map, st.st_size);
+
+    return true;
+}
+
+void free_log_replay(log_replay_t *replay)
+{
+    free(replay->entries);
+    memset(replay, 0, sizeof(*replay));
+}
@@ -0,0 +1,80 @@
+#ifndef __RESULT_LOG_INC__
+#define __RESULT_LOG_INC__
+
+#include <stdbool.h>
+
+#include "shared_data.h"
+
+/// @brief Append-only log of input values and received results, for resume after interruption.
+///
+/// Records are buffered in memory, written once per communication cycle and
+/// synchronized with disk not more often than once per sync interval.
+typedef struct _result_log result_log_t;
+
+struct _log_entry
+{
+    int x;                         // Input value
+    unsigned char known;           // Bit mask of nodes with logged results
+    value_t result[NODES_COUNT];   // Logged results of f(x) and g(x)
+};
+
+/// @brief Input value which is not printed yet, restored from log
+typedef struct _log_entry log_entry_t;
+
+struct _log_replay
+{
+    log_entry_t *entries; // Values which are not printed, in input order
+    long long count;      // Number of entries
+    long long first_seq;  // Sequence number of the first entry, number of printed values
+    long long inputs;     // Number of logged input values
+};
+
+/// @brief State restored from log
+typedef struct _log_replay log_replay_t;
+
+/// @brief Open log for writing
+/// @param path    Log file name
+/// @param funcs   Names of f(x), g(x) and final operation, stored in log header
+/// @param append  Append to existing log, it must be replayed by result_log_replay() before
+/// @return Log instance, NULL on failure
+result_log_t *construct_result_log(const char *path, const char *const funcs[3], bool append);
+
+/// @brief Write buffered records, synchronize with disk, close
+/// @param log Log allocated by construct_result_log()
+void destruct_result_log(result_log_t *log);
+
+/// @brief Read log, restore values which are not printed yet
+/// @param path    Log file name
+/// @param funcs   Names of f(x), g(x) and final operation, must match log header
+/// @param replay  Restored state, empty if log doesn't exist
+/// @return True, on success
+bool result_log_replay(const char *path, const char *const funcs[3], log_replay_t *replay);
+
+/// @brief Release restored state
+/// @param replay State filled by result_log_replay()
+void free_log_replay(log_replay_t *replay);
+
+/// @brief Log input value, entered computation
+/// @param log Log
+/// @param seq Sequence number of input value
+/// @param x   Input value
+void log_input(result_log_t *log, long long seq, int x);
+
+/// @brief Log result of computation node
+/// @param log   Log
+/// @param seq   Sequence number of input value
+/// @param node  Computation node
+/// @param value Received result
+void log_result(result_log_t *log, long long seq, computation_node node, const value_t *value);
+
+/// @brief Mark values as printed
+/// @param log Log
+/// @param seq Sequence number of the first value, which is not printed
+void log_printed(result_log_t *log, long long seq);
+
+/// @brief Write buffered records, synchronize with disk if sync interval is elapsed
+/// @param log Log
+/// @return True, on success
+bool flush_result_log(result_log_t *log);
+
+#endif // __RESULT_LOG_INC__
@@ -0,0 +1,28 @@
+#include <stdlib.h>
+
+#include "registry.h"
+#include "result_store.h"
+
+bool column_init(value_column_t *col, tf_result_t type, int capacity)
+{
+    col->type = type;
+    col->status = calloc(capacity, sizeof(col->status[0]));
+    col->data = calloc(capacity, result_types[type].size);
+
+    if (col->status == NULL || col->data == NULL)
+    {
+        column_free(col);
+        return false;
+    }
+
+    return true;
+}
+
+void column_free(value_column_t *col)
+{
+    free(col->status);
+    free(col->data);
+
+    col->status = NULL;
+    col->data = NULL;
+}
@@ -0,0 +1,43 @@
+#ifndef __RESULT_STORE_INC__
+#define __RESULT_STORE_INC__
+
+#include <stdbool.h>
+
+#include "shared_data.h"
+
+/// @brief Column of calculated values of the single type (struct of arrays).
+///
+/// Status bytes and payload are kept in separate arrays, so ready ranges
+/// can be casted and combined by tight loops, without per-value switching.
+struct _value_column
+{
+    tf_result_t type;      // Type of stored values
+    unsigned char *status; // compfunc_status_t of each value
+
+    /// @brief Payload array, type is selected by column type
+    union
+    {
+        void *data;
+        bool *b_val;
+        double *d_val;
+        int *i_val;
+        unsigned int *ui_val;
+    };
+};
+
+typedef struct _value_column value_column_t;
+
+/// @brief Allocate column storage
+/// @param col      Column
+/// @param type     Type of stored values
+/// @param capacity Number of values
+/// @return True, on success
+bool column_init(value_column_t *col, tf_result_t type, int capacity);
+
+/// @brief Release column storage
+/// @param col Column initialized by column_init()
+void column_free(value_column_t *col);
+
+// Store, load and convert operations are provided by value types registry, see registry.h
+
+#endif // __RESULT_STORE_INC__
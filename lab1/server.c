@@ -0,0 +1,1043 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <stdio.h>
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/param.h>
+#include <memory.h>
+#include <limits.h>
+#include <time.h>
+
+#include <compfuncs.h>
+
+#include "backlog.h"
+#include "computation.h"
+#include "input_parser.h"
+#include "registry.h"
+#include "result_store.h"
+#include "server.h"
+#include "shared_data.h"
+
+#define SERVER_PIPE_MODE (S_IFIFO | 0640)
+#define SERVER_QUEUE 1024          // Values of single client in computation
+#define SERVER_SEGMENT 4096        // Backlog segment of single client
+#define SERVER_BACKLOG 65536       // Waiting values of single client, reading is paused over it
+#define SERVER_OUT_LIMIT (1 << 20) // Unsent results of single client, finalization is paused over it
+#define SERVER_READ_BUFF 65536     // Buffer for reading client input
+#define SERVER_CONFIG_MAX 128      // Maximal length of configuration line
+#define SERVER_LINE_MAX 256        // Space reserved for single result line
+#define SERVER_PIPE_NAME 64        // Size of named pipe path, with pid and worker number
+#define SERVER_WORKER_TIMEOUT 15000000LL // Time without results of worker with values in flight, microseconds
+#define SERVER_POOL_WORKERS 4      // Worker processes of single trial function of the node
+#define SERVER_WORKER_BATCH ((int)(PIPE_BUF / sizeof(int))) // Values sent to idle worker, they fit single write
+
+typedef struct _session session_t;
+
+struct _work_item
+{
+    session_t *session; // Client
+    int pos;            // Position in client queue
+};
+
+/// @brief Value of client, waiting for transmission to worker or for result
+typedef struct _work_item work_item_t;
+
+struct _work_queue
+{
+    work_item_t *items; // Circular buffer, grows on demand
+    int head;           // Index of the first item
+    int count;          // Number of items
+    int capacity;       // Size of circular buffer
+};
+
+/// @brief FIFO of values, shared by all clients of the pool
+typedef struct _work_queue work_queue_t;
+
+struct _worker
+{
+    pid_t pid;                      // Worker process, -1 if it is not running
+    int comm_fd;                    // Channel for x values
+    int result_fd;                  // Channel for results
+    char pipe[2][SERVER_PIPE_NAME]; // Named pipes of worker
+    work_queue_t in_flight;         // Values sent to worker, in order of transmission
+    long long deadline;             // Time of the next result, while values are in flight, microseconds
+};
+
+/// @brief Worker process of the pool
+typedef struct _worker worker_t;
+
+struct _pool
+{
+    computation_node node;                    // Node served by workers
+    trial_function_t func;                    // Trial function of workers
+    worker_t workers[SERVER_POOL_WORKERS];    // Workers, hanging value stalls only one of them
+    work_queue_t pending;                     // Values waiting for transmission, including retries
+    struct _pool *next;                       // Next pool
+};
+
+/// @brief Worker processes, shared by clients with the same trial function of the node
+typedef struct _pool pool_t;
+
+struct _session
+{
+    int fd;                                       // Client connection, -1 when closed
+    char config[SERVER_CONFIG_MAX];               // Received part of configuration line
+    int config_len;                               // Length of received configuration
+    bool configured;                              // Configuration line is received
+    trial_function_t trial_function[NODES_COUNT]; // Trial functions
+    tf_result_t output_type[NODES_COUNT];         // Types of f(x) and g(x)
+    pool_t *pool[NODES_COUNT];                    // Workers of f and g
+    input_parser_t *parser;                       // Tokenizer of input values
+    backlog_t *backlog;                           // Input values, waiting for free space in queue
+    bool input_eof;                               // Client shut down its side of connection
+    int *x_values;                                // Input values queue
+    calculated_value_t *calc_state[NODES_COUNT];  // Communication state of f(x) and g(x), in queue order
+    value_column_t results[NODES_COUNT];          // Calculated f(x) and g(x), in queue order
+    final_stage_t final;                          // Final operation, in queue order
+    int x_head_pos;                               // Index of the first value, not finalized
+    int x_current_pos;                            // Index of the first value waiting for results
+    int x_free_pos;                               // Index of free element in circular queue
+    char *out;                                    // Formatted results, not sent yet
+    size_t out_pos;                               // Sent part of results
+    size_t out_len;                               // Length of formatted results
+    size_t out_capacity;                          // Size of results buffer
+    bool closing;                                 // Close connection after results are sent
+    int refs;                                     // Values in worker queues
+    struct _session *next;                        // Next client
+};
+
+struct _server
+{
+    int listen_fd;       // Listening socket
+    char *socket_path;   // Path of socket
+    pool_t *pools;       // Started pools
+    int worker_count;    // Number of started workers, including restarted ones, for unique pipe names
+    session_t *sessions; // Clients
+    char *read_buff;     // Buffer for reading client input
+};
+
+static char node_name[NODES_COUNT] = {'f', 'g'};
+
+static long long real_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static bool work_queue_push(work_queue_t *q, session_t *session, int pos)
+{
+    if (q->count == q->capacity)
+    {
+        int capacity = MAX(256, q->capacity * 2);
+        work_item_t *items = malloc(sizeof(work_item_t) * capacity);
+
+        if (items == NULL)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < q->count; i++)
+        {
+            items[i] = q->items[(q->head + i) % q->capacity];
+        }
+
+        free(q->items);
+        q->items = items;
+        q->head = 0;
+        q->capacity = capacity;
+    }
+
+    q->items[(q->head + q->count) % q->capacity] = (work_item_t){session, pos};
+    q->count++;
+
+    return true;
+}
+
+/// @brief Put items of other queue in front of the queue, in their order, other queue is emptied
+static bool work_queue_prepend(work_queue_t *q, work_queue_t *other)
+{
+    while (other->count > 0)
+    {
+        // Push reserves space, queue is shifted to start with the last item of other queue
+        work_item_t item = other->items[(other->head + other->count - 1) % other->capacity];
+
+        if (!work_queue_push(q, item.session, item.pos))
+        {
+            return false;
+        }
+
+        q->head = (q->head + q->capacity - 1) % q->capacity;
+        q->items[q->head] = item;
+        other->count--;
+    }
+
+    return true;
+}
+
+static work_item_t work_queue_pop(work_queue_t *q)
+{
+    work_item_t item = q->items[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+    return item;
+}
+
+server_t *construct_server(const char *socket_path)
+{
+    struct sockaddr_un addr;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "server: Socket path is too long - %s\n", socket_path);
+        return NULL;
+    }
+
+    server_t *srv = calloc(1, sizeof(server_t));
+
+    if (srv == NULL)
+    {
+        return NULL;
+    }
+
+    srv->read_buff = malloc(SERVER_READ_BUFF);
+    srv->socket_path = strdup(socket_path);
+    srv->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+
+    unlink(socket_path);
+
+    if (srv->read_buff == NULL || srv->socket_path == NULL || srv->listen_fd == -1 ||
+        bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(srv->listen_fd, SOMAXCONN) == -1)
+    {
+        fprintf(stderr, "server: Failed to listen on %s (%d)\n", socket_path, errno);
+        if (srv->listen_fd != -1)
+        {
+            close(srv->listen_fd);
+        }
+        free(srv->read_buff);
+        free(srv->socket_path);
+        free(srv);
+        return NULL;
+    }
+
+    if (srv->listen_fd >= FD_SETSIZE)
+    {
+        printf("HUGE file descriptor - %d, upgrade to poll(2)\n", srv->listen_fd);
+    }
+
+    printf("Listening on %s\n", socket_path);
+
+    return srv;
+}
+
+static void free_session(session_t *s)
+{
+    if (s->fd != -1)
+    {
+        close(s->fd);
+    }
+
+    if (s->parser != NULL)
+    {
+        destruct_input_parser(s->parser);
+    }
+
+    if (s->backlog != NULL)
+    {
+        destruct_backlog(s->backlog);
+    }
+
+    free(s->x_values);
+
+    for (int i = 0; i < NODES_COUNT; i++)
+    {
+        free(s->calc_state[i]);
+        column_free(&s->results[i]);
+    }
+
+    final_stage_free(&s->final);
+    free(s->out);
+    free(s);
+}
+
+static void stop_worker(worker_t *w)
+{
+    // Worker exits on end of input, hanging one is terminated
+    if (w->comm_fd != -1)
+    {
+        close(w->comm_fd);
+    }
+
+    if (w->result_fd != -1)
+    {
+        close(w->result_fd);
+    }
+
+    if (w->pid != -1)
+    {
+        kill(w->pid, SIGTERM);
+        waitpid(w->pid, NULL, 0);
+    }
+
+    remove(w->pipe[0]);
+    remove(w->pipe[1]);
+
+    w->pid = -1;
+    w->comm_fd = -1;
+    w->result_fd = -1;
+}
+
+static void stop_pool(pool_t *pool)
+{
+    for (int n = 0; n < SERVER_POOL_WORKERS; n++)
+    {
+        stop_worker(&pool->workers[n]);
+        free(pool->workers[n].in_flight.items);
+    }
+
+    free(pool->pending.items);
+    free(pool);
+}
+
+void destruct_server(server_t *srv)
+{
+    while (srv->sessions != NULL)
+    {
+        session_t *next = srv->sessions->next;
+        free_session(srv->sessions);
+        srv->sessions = next;
+    }
+
+    while (srv->pools != NULL)
+    {
+        pool_t *next = srv->pools->next;
+        stop_pool(srv->pools);
+        srv->pools = next;
+    }
+
+    close(srv->listen_fd);
+    unlink(srv->socket_path);
+
+    free(srv->socket_path);
+    free(srv->read_buff);
+    free(srv);
+}
+
+/// @brief Start worker process with its own named pipes
+static bool spawn_worker(server_t *srv, pool_t *pool, worker_t *w)
+{
+    computation_node node = pool->node;
+
+    snprintf(w->pipe[0], sizeof(w->pipe[0]), "/tmp/lab_1_25_d%d_%c%d_pipe", getpid(), node_name[node], srv->worker_count);
+    snprintf(w->pipe[1], sizeof(w->pipe[1]), "/tmp/lab_1_25_d%d_%c%d_pipe_res", getpid(), node_name[node], srv->worker_count);
+    srv->worker_count++;
+
+    mkfifo(w->pipe[0], SERVER_PIPE_MODE);
+    mkfifo(w->pipe[1], SERVER_PIPE_MODE);
+
+    char node_arg[2] = {node_name[node], '\0'};
+    char *args[] = {
+        (char *)calc_task,
+        node_arg,
+        (char *)tf_name(pool->func),
+        w->pipe[0],
+        w->pipe[1],
+        NULL};
+
+    w->pid = -1;
+    w->comm_fd = -1;
+    w->result_fd = -1;
+
+    if (posix_spawn(&w->pid, calc_task, NULL, NULL, args, NULL) != 0)
+    {
+        fprintf(stderr, "server: Failed to start %c node - %s\n", node_name[node], tf_name(pool->func));
+        w->pid = -1;
+        stop_worker(w);
+        return false;
+    }
+
+    w->comm_fd = open(w->pipe[0], O_WRONLY | O_CLOEXEC);
+    w->result_fd = open(w->pipe[1], O_RDONLY | O_CLOEXEC);
+
+    if (w->comm_fd == -1 || w->result_fd == -1 || w->comm_fd >= FD_SETSIZE || w->result_fd >= FD_SETSIZE)
+    {
+        fprintf(stderr, "server: Named pipe open failed %s\n", w->pipe[0]);
+        stop_worker(w);
+        return false;
+    }
+
+    return true;
+}
+
+static pool_t *start_pool(server_t *srv, computation_node node, trial_function_t func)
+{
+    pool_t *pool = calloc(1, sizeof(pool_t));
+
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+
+    pool->node = node;
+    pool->func = func;
+
+    for (int n = 0; n < SERVER_POOL_WORKERS; n++)
+    {
+        pool->workers[n].pid = -1;
+        pool->workers[n].comm_fd = -1;
+        pool->workers[n].result_fd = -1;
+    }
+
+    for (int n = 0; n < SERVER_POOL_WORKERS; n++)
+    {
+        if (!spawn_worker(srv, pool, &pool->workers[n]))
+        {
+            stop_pool(pool);
+            return NULL;
+        }
+    }
+
+    pool->next = srv->pools;
+    srv->pools = pool;
+
+    printf("Workers %c_%s started: %d\n", node_name[node], tf_name(func), SERVER_POOL_WORKERS);
+
+    return pool;
+}
+
+/// @brief Value fails for its client, it is not computed
+static void fail_item(pool_t *pool, work_item_t item)
+{
+    session_t *s = item.session;
+
+    s->refs--;
+
+    if (s->fd == -1)
+    {
+        return;
+    }
+
+    value_t val;
+    memset(&val, 0, sizeof(val));
+    val.status = COMPFUNC_HARD_FAIL;
+
+    receive_result(&s->calc_state[pool->node][item.pos], &s->results[pool->node], item.pos, &val, false);
+}
+
+/// @brief Replace worker, which exited or hangs. Results arrive in order, so the first value in flight is
+/// the one in computation, it fails for its client. Values behind it are sent again, before pending ones
+static void restart_worker(server_t *srv, pool_t *pool, worker_t *w)
+{
+    stop_worker(w);
+
+    if (w->in_flight.count > 0)
+    {
+        work_item_t item = work_queue_pop(&w->in_flight);
+
+        fprintf(stderr, "server: Worker %c_%s failed on x = %d, %d values in flight are sent again\n",
+                node_name[pool->node], tf_name(pool->func), item.session->x_values[item.pos], w->in_flight.count);
+        fail_item(pool, item);
+    }
+
+    if (!work_queue_prepend(&pool->pending, &w->in_flight))
+    {
+        while (w->in_flight.count > 0)
+        {
+            fail_item(pool, work_queue_pop(&w->in_flight));
+        }
+    }
+
+    if (spawn_worker(srv, pool, w))
+    {
+        printf("Worker %c_%s restarted\n", node_name[pool->node], tf_name(pool->func));
+    }
+}
+
+static pool_t *find_pool(server_t *srv, computation_node node, trial_function_t func)
+{
+    for (pool_t *pool = srv->pools; pool != NULL; pool = pool->next)
+    {
+        if (pool->node == node && pool->func == func)
+        {
+            return pool;
+        }
+    }
+
+    return start_pool(srv, node, func);
+}
+
+/// @brief Reserve space for result line
+static char *reserve_out(session_t *s)
+{
+    if (s->out_pos > 0)
+    {
+        // Drop sent part
+        memmove(s->out, s->out + s->out_pos, s->out_len - s->out_pos);
+        s->out_len -= s->out_pos;
+        s->out_pos = 0;
+    }
+
+    if (s->out_capacity - s->out_len < SERVER_LINE_MAX)
+    {
+        size_t capacity = MAX(2 * s->out_capacity, 65536);
+        char *out = realloc(s->out, capacity);
+
+        if (out == NULL)
+        {
+            return NULL;
+        }
+
+        s->out = out;
+        s->out_capacity = capacity;
+    }
+
+    return s->out + s->out_len;
+}
+
+static void reject_session(session_t *s, const char *reason)
+{
+    char *line = reserve_out(s);
+
+    if (line != NULL)
+    {
+        s->out_len += snprintf(line, SERVER_LINE_MAX, "%s\n", reason);
+    }
+
+    s->closing = true;
+}
+
+/// @brief Parse configuration line, allocate computation queue
+static void configure_session(server_t *srv, session_t *s)
+{
+    char names[3][SERVER_CONFIG_MAX];
+    trial_function_t funcs[3];
+
+    s->configured = true;
+
+    if (sscanf(s->config, "%127s %127s %127s", names[0], names[1], names[2]) != 3)
+    {
+        reject_session(s, "Expected configuration: <f_function> <g_function> <final_operation>");
+        return;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        funcs[i] = function_from_name(names[i]);
+        if (funcs[i] == TF_UNKNOWN)
+        {
+            reject_session(s, "Unsupported function/operation");
+            return;
+        }
+    }
+
+    bool allocated = true;
+
+    for (int i = 0; i < NODES_COUNT; i++)
+    {
+        s->trial_function[i] = funcs[i];
+        s->output_type[i] = trial_result_type(funcs[i]);
+        s->pool[i] = find_pool(srv, i, funcs[i]);
+        s->calc_state[i] = calloc(SERVER_QUEUE, sizeof(calculated_value_t));
+        allocated = allocated && s->pool[i] != NULL && s->calc_state[i] != NULL && column_init(&s->results[i], s->output_type[i], SERVER_QUEUE);
+    }
+
+    // Cast is required only if node type differs from final type
+    allocated = allocated && final_stage_init(&s->final, &funcs[2], 1, s->results, SERVER_QUEUE);
+
+    s->x_values = malloc(sizeof(int) * SERVER_QUEUE);
+    s->parser = construct_input_parser(false);
+    s->backlog = construct_backlog(SERVER_SEGMENT, SERVER_BACKLOG, NULL);
+
+    allocated = allocated && s->x_values != NULL && s->parser != NULL && s->backlog != NULL;
+
+    if (!allocated)
+    {
+        reject_session(s, "Server failure");
+    }
+}
+
+static void accept_clients(server_t *srv)
+{
+    while (true)
+    {
+        int fd = accept(srv->listen_fd, NULL, NULL);
+
+        if (fd == -1)
+        {
+            return;
+        }
+
+        // Workers started later shouldn't keep connection open
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        if (fd >= FD_SETSIZE)
+        {
+            printf("HUGE file descriptor - %d, upgrade to poll(2)\n", fd);
+            close(fd);
+            continue;
+        }
+
+        session_t *s = calloc(1, sizeof(session_t));
+
+        if (s == NULL)
+        {
+            close(fd);
+            continue;
+        }
+
+        s->fd = fd;
+        s->next = srv->sessions;
+        srv->sessions = s;
+    }
+}
+
+static void close_session(session_t *s)
+{
+    close(s->fd);
+    s->fd = -1;
+}
+
+static void read_session(server_t *srv, session_t *s)
+{
+    ssize_t result = read(s->fd, srv->read_buff, SERVER_READ_BUFF);
+
+    if (result == -1)
+    {
+        if (errno != EINTR && errno != EAGAIN)
+        {
+            close_session(s);
+        }
+        return;
+    }
+
+    const char *data = srv->read_buff;
+    size_t len = result;
+
+    // Configuration line comes first
+    while (!s->configured && len > 0)
+    {
+        if (*data == '\n')
+        {
+            configure_session(srv, s);
+        }
+        else if (s->config_len == SERVER_CONFIG_MAX - 1)
+        {
+            s->configured = true;
+            reject_session(s, "Configuration line is too long");
+        }
+        else
+        {
+            s->config[s->config_len++] = *data;
+        }
+
+        data++;
+        len--;
+    }
+
+    if (s->closing)
+    {
+        return;
+    }
+
+    if (result == 0)
+    {
+        s->input_eof = true;
+
+        if (!s->configured && s->config_len > 0)
+        {
+            // Configuration line without line feed
+            configure_session(srv, s);
+        }
+
+        if (!s->configured)
+        {
+            close_session(s);
+        }
+        else if (s->closing)
+        {
+            return;
+        }
+        else if (!input_finish(s->parser, s->backlog))
+        {
+            reject_session(s, "Server failure");
+        }
+    }
+    else if (len > 0 && !input_parse(s->parser, data, len, s->backlog))
+    {
+        reject_session(s, "Server failure");
+    }
+}
+
+/// @brief Move waiting input values to free space of client queue, schedule them for workers
+static void refill_session(session_t *s)
+{
+    while (backlog_size(s->backlog) > 0)
+    {
+        int limit = queue_free_end(s->x_head_pos, s->x_free_pos, SERVER_QUEUE);
+        int count = backlog_pop(s->backlog, &s->x_values[s->x_free_pos], limit - s->x_free_pos);
+
+        if (count == 0)
+        {
+            break;
+        }
+
+        for (int pos = s->x_free_pos; pos < s->x_free_pos + count; pos++)
+        {
+            for (int i = 0; i < NODES_COUNT; i++)
+            {
+                memset(&s->calc_state[i][pos], 0, sizeof(calculated_value_t));
+                work_queue_push(&s->pool[i]->pending, s, pos);
+                s->refs++;
+            }
+        }
+
+        s->x_free_pos = (s->x_free_pos + count) % SERVER_QUEUE;
+    }
+}
+
+/// @brief Send share of pending values of all clients to idle worker
+static bool send_worker(pool_t *pool, worker_t *w, int share)
+{
+    int x_batch[SERVER_WORKER_BATCH];
+    work_item_t items[SERVER_WORKER_BATCH];
+    int count = 0;
+    int limit = MIN(share, SERVER_WORKER_BATCH);
+
+    while (count < limit && pool->pending.count > 0)
+    {
+        work_item_t item = work_queue_pop(&pool->pending);
+
+        if (item.session->fd == -1)
+        {
+            // Client is gone
+            item.session->refs--;
+            continue;
+        }
+
+        items[count] = item;
+        x_batch[count] = item.session->x_values[item.pos];
+        count++;
+    }
+
+    if (count == 0)
+    {
+        return true;
+    }
+
+    if (write(w->comm_fd, x_batch, sizeof(int) * count) == -1)
+    {
+        // Values are not sent, they wait for another worker
+        for (int j = 0; j < count; j++)
+        {
+            work_queue_push(&pool->pending, items[j].session, items[j].pos);
+        }
+        return false;
+    }
+
+    w->deadline = real_now() + SERVER_WORKER_TIMEOUT;
+
+    for (int j = 0; j < count; j++)
+    {
+        items[j].session->calc_state[pool->node][items[j].pos].comm = CS_SENT;
+        work_queue_push(&w->in_flight, items[j].session, items[j].pos);
+    }
+
+    return true;
+}
+
+/// @brief Receive results, they arrive in order of transmission
+static bool receive_worker(pool_t *pool, worker_t *w)
+{
+    value_t val[PIPE_BUF / sizeof(value_t)];
+    ssize_t result = read(w->result_fd, val, sizeof(val));
+
+    if (result <= 0 || result % sizeof(value_t) != 0 || result / sizeof(value_t) > w->in_flight.count)
+    {
+        fprintf(stderr, "COMM failed %c_%s: %ld\n", node_name[pool->node], tf_name(pool->func), (long)result);
+        return false;
+    }
+
+    // The next value is given the same time
+    w->deadline = real_now() + SERVER_WORKER_TIMEOUT;
+
+    for (int j = 0; j < result / sizeof(value_t); j++)
+    {
+        work_item_t item = work_queue_pop(&w->in_flight);
+        session_t *s = item.session;
+
+        s->refs--;
+
+        if (s->fd == -1)
+        {
+            continue;
+        }
+
+        if (receive_result(&s->calc_state[pool->node][item.pos], &s->results[pool->node], item.pos, &val[j], true))
+        {
+            // Retry calculation, possibly by another worker
+            work_queue_push(&pool->pending, s, item.pos);
+            s->refs++;
+        }
+    }
+
+    return true;
+}
+
+/// @brief Apply final operation to values with both results, format result lines
+static void finalize_session(session_t *s)
+{
+    s->x_current_pos = queue_ready_end(s->calc_state, s->x_current_pos, s->x_free_pos, SERVER_QUEUE);
+
+    // Ready range is split in two, if it wraps around circular queue
+    while (s->x_head_pos != s->x_current_pos && s->out_len - s->out_pos < SERVER_OUT_LIMIT)
+    {
+        int begin = s->x_head_pos;
+        int end = s->x_current_pos > begin ? s->x_current_pos : SERVER_QUEUE;
+
+        final_stage_run(&s->final, s->results, begin, end - begin);
+
+        for (int i = begin; i < end; i++)
+        {
+            char *line = reserve_out(s);
+
+            if (line == NULL)
+            {
+                close_session(s);
+                return;
+            }
+
+            int len = snprintf(line, SERVER_LINE_MAX, "Final expression for %d ", s->x_values[i]);
+
+            if (s->final.results[0].status[i] == COMPFUNC_SUCCESS)
+            {
+                value_t result;
+                result_types[s->final.type[0]].load(&s->final.results[0], i, &result);
+                len += result_types[s->final.type[0]].format(line + len, SERVER_LINE_MAX - len - 1, &result);
+            }
+            else
+            {
+                len += snprintf(line + len, SERVER_LINE_MAX - len - 1, "calculation failed");
+            }
+
+            line[len++] = '\n';
+            s->out_len += len;
+        }
+
+        s->x_head_pos = end % SERVER_QUEUE;
+    }
+}
+
+static void write_session(session_t *s)
+{
+    ssize_t result = send(s->fd, s->out + s->out_pos, s->out_len - s->out_pos, MSG_NOSIGNAL);
+
+    if (result == -1)
+    {
+        if (errno != EINTR && errno != EAGAIN)
+        {
+            close_session(s);
+        }
+        return;
+    }
+
+    s->out_pos += result;
+}
+
+static bool session_finished(const session_t *s)
+{
+    bool computed = s->input_eof && s->backlog != NULL && backlog_size(s->backlog) == 0 && s->x_head_pos == s->x_free_pos;
+
+    return (s->closing || computed) && s->out_pos == s->out_len;
+}
+
+bool serve(server_t *srv)
+{
+    for (session_t *s = srv->sessions; s != NULL; s = s->next)
+    {
+        if (s->fd != -1 && s->configured && !s->closing)
+        {
+            refill_session(s);
+        }
+    }
+
+    fd_set data_streams;
+    fd_set out_streams;
+
+    FD_ZERO(&data_streams);
+    FD_ZERO(&out_streams);
+
+    FD_SET(srv->listen_fd, &data_streams);
+    int nfds = srv->listen_fd;
+
+    for (session_t *s = srv->sessions; s != NULL; s = s->next)
+    {
+        if (s->fd == -1)
+        {
+            continue;
+        }
+
+        // Input waits in socket buffer, while client backlog is full
+        if (!s->input_eof && !s->closing && (s->backlog == NULL || backlog_size(s->backlog) < SERVER_BACKLOG))
+        {
+            FD_SET(s->fd, &data_streams);
+            nfds = MAX(nfds, s->fd);
+        }
+
+        if (s->out_pos < s->out_len)
+        {
+            FD_SET(s->fd, &out_streams);
+            nfds = MAX(nfds, s->fd);
+        }
+    }
+
+    for (pool_t *pool = srv->pools; pool != NULL; pool = pool->next)
+    {
+        int running = 0;
+
+        for (int n = 0; n < SERVER_POOL_WORKERS; n++)
+        {
+            worker_t *w = &pool->workers[n];
+
+            // Worker failed to start again
+            if (w->pid == -1 && !spawn_worker(srv, pool, w))
+            {
+                continue;
+            }
+
+            running++;
+
+            FD_SET(w->result_fd, &data_streams);
+            nfds = MAX(nfds, w->result_fd);
+
+            // Values are given to idle workers only, they don't wait behind hanging value
+            if (pool->pending.count > 0 && w->in_flight.count == 0)
+            {
+                FD_SET(w->comm_fd, &out_streams);
+                nfds = MAX(nfds, w->comm_fd);
+            }
+        }
+
+        // Values fail, until any worker starts
+        while (running == 0 && pool->pending.count > 0)
+        {
+            fail_item(pool, work_queue_pop(&pool->pending));
+        }
+    }
+
+    struct timeval io_timeout;
+
+    io_timeout.tv_sec = 0;
+    io_timeout.tv_usec = 250000;
+
+    int sel_result = select(nfds + 1, &data_streams, &out_streams, NULL, &io_timeout);
+
+    if (sel_result == -1)
+    {
+        // Interrupted by user, otherwise failure
+        return errno == EINTR;
+    }
+
+    if (FD_ISSET(srv->listen_fd, &data_streams))
+    {
+        accept_clients(srv);
+    }
+
+    for (session_t *s = srv->sessions; s != NULL; s = s->next)
+    {
+        if (s->fd != -1 && FD_ISSET(s->fd, &data_streams))
+        {
+            read_session(srv, s);
+        }
+    }
+
+    // Failure of worker affects only the value in computation
+    long long now = real_now();
+
+    for (pool_t *pool = srv->pools; pool != NULL; pool = pool->next)
+    {
+        // Pending values are spread over idle workers
+        int writable = 0;
+
+        for (int n = 0; n < SERVER_POOL_WORKERS; n++)
+        {
+            writable += pool->workers[n].pid != -1 && FD_ISSET(pool->workers[n].comm_fd, &out_streams);
+        }
+
+        int share = (pool->pending.count + writable - 1) / MAX(writable, 1);
+
+        for (int n = 0; n < SERVER_POOL_WORKERS; n++)
+        {
+            worker_t *w = &pool->workers[n];
+
+            if (w->pid == -1)
+            {
+                continue;
+            }
+
+            if (FD_ISSET(w->result_fd, &data_streams) && !receive_worker(pool, w))
+            {
+                restart_worker(srv, pool, w);
+                continue;
+            }
+
+            if (FD_ISSET(w->comm_fd, &out_streams) && !send_worker(pool, w, share))
+            {
+                restart_worker(srv, pool, w);
+                continue;
+            }
+
+            if (w->in_flight.count > 0 && now > w->deadline)
+            {
+                fprintf(stderr, "server: Worker %c_%s gave no results for %lld s\n", node_name[pool->node], tf_name(pool->func), SERVER_WORKER_TIMEOUT / 1000000);
+                restart_worker(srv, pool, w);
+            }
+        }
+    }
+
+    // Stream results back, close finished connections, release clients without values in workers
+    session_t **link = &srv->sessions;
+
+    while (*link != NULL)
+    {
+        session_t *s = *link;
+
+        if (s->fd != -1 && s->configured && !s->closing)
+        {
+            finalize_session(s);
+        }
+
+        if (s->fd != -1 && s->out_pos < s->out_len)
+        {
+            write_session(s);
+        }
+
+        if (s->fd != -1 && session_finished(s))
+        {
+            close_session(s);
+        }
+
+        if (s->fd == -1 && s->refs == 0)
+        {
+            *link = s->next;
+            free_session(s);
+            continue;
+        }
+
+        link = &s->next;
+    }
+
+    return true;
+}
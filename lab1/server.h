@@ -0,0 +1,32 @@
+#ifndef __SERVER_INC__
+#define __SERVER_INC__
+
+#include <stdbool.h>
+
+/// @brief Daemon mode of manager, serves many clients over Unix domain socket.
+///
+/// Client sends configuration line "<f_function> <g_function> <final_operation>",
+/// then input values, one per line. Final results are streamed back, in the format
+/// of manager output, connection is closed after the last result, when client
+/// shuts down its side of connection.
+///
+/// Workers are shared between clients: single calculon process per node and
+/// trial function, started on the first request. Values of all clients are
+/// batched together to the same worker, in order of arrival.
+typedef struct _server server_t;
+
+/// @brief Listen on socket
+/// @param socket_path Path of Unix domain socket, replaced if exists
+/// @return Server instance, NULL on failure
+server_t *construct_server(const char *socket_path);
+
+/// @brief Close connections, stop workers, remove socket
+/// @param srv Server allocated by construct_server()
+void destruct_server(server_t *srv);
+
+/// @brief Accept clients, send and receive data, stream results
+/// @param srv Server instance
+/// @return True, if no failures in inter process communication
+bool serve(server_t *srv);
+
+#endif // __SERVER_INC__
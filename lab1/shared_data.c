@@ -1,5 +1,6 @@
 #include <string.h>
 
+#include "registry.h"
 #include "shared_data.h"
 
 const char *node_pipe[NODES_COUNT][2] = {
@@ -9,31 +10,17 @@ const char *node_pipe[NODES_COUNT][2] = {
 
 const char *calc_task = "calculon";
 
-// NOTE: order must match enum _trial_functions
-const char *trial_functions[TF_COUNT] = {
-    "imul",
-    "imin",
-    "fmul",
-    "and",
-    "or",
-};
+const char *replay_task = "replayon";
 
-// NOTE: order must match enum _trial_functions
-tf_result_t tf_results[TF_COUNT] = {
-    TFR_INT,
-    TFR_UINT,
-    TFR_FLOAT,
-    TFR_BOOL,
-    TFR_BOOL,
-};
+const int MAX_SOFT_RETRY = 10;
 
 trial_function_t function_from_name(const char *tf)
 {
     trial_function_t result = TF_UNKNOWN;
 
-    for (trial_function_t i = TF_IMUL; i < TF_COUNT; i++)
+    for (trial_function_t i = 0; i < TF_COUNT; i++)
     {
-        if (strcmp(tf, trial_functions[i]) == 0)
+        if (strcmp(tf, trial_ops[i].name) == 0)
         {
             result = i;
             break;
@@ -43,11 +30,53 @@ trial_function_t function_from_name(const char *tf)
     return result;
 }
 
+int functions_from_list(const char *list, trial_function_t funcs[TF_COUNT])
+{
+    int count = 0;
+
+    while (true)
+    {
+        size_t len = strcspn(list, ",");
+        trial_function_t tf = TF_UNKNOWN;
+
+        for (trial_function_t i = 0; i < TF_COUNT; i++)
+        {
+            if (strlen(trial_ops[i].name) == len && strncmp(list, trial_ops[i].name, len) == 0)
+            {
+                tf = i;
+            }
+        }
+
+        // Every function once
+        for (int i = 0; i < count; i++)
+        {
+            if (funcs[i] == tf)
+            {
+                tf = TF_UNKNOWN;
+            }
+        }
+
+        if (tf == TF_UNKNOWN)
+        {
+            return 0;
+        }
+
+        funcs[count++] = tf;
+
+        if (list[len] == '\0')
+        {
+            return count;
+        }
+
+        list += len + 1;
+    }
+}
+
 tf_result_t trial_result_type(trial_function_t tf)
 {
     if (tf != TF_UNKNOWN)
     {
-        return tf_results[tf];
+        return trial_ops[tf].result_type;
     }
 
     return TFR_UNKNOWN;
@@ -57,7 +86,7 @@ const char *tf_name(trial_function_t tf)
 {
     if (tf != TF_UNKNOWN)
     {
-        return trial_functions[tf];
+        return trial_ops[tf].name;
     }
 
     return NULL;
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 
 #include <compfuncs.h>
+#include <trialfuncs.h>
 
 enum _computation_node
 {
@@ -35,14 +36,40 @@ extern const char *node_pipe[NODES_COUNT][2];
 
 extern const char *calc_task;
 
+/// @brief Stand-in for calc_task, answers with recorded results
+extern const char *replay_task;
+
+/// @brief Maximal number of soft fail retries, fits 6 bits of calculated_value_t
+extern const int MAX_SOFT_RETRY;
+
+enum _comm_status
+{
+    CS_NONE,
+    CS_SENT,
+    CS_RECEIVED,
+};
+
+/// @brief Is data send over named pipe, is response received?
+typedef enum _comm_status comm_status_t;
+
+struct _calculated_value
+{
+    unsigned char comm : 2;       // comm_status_t
+    unsigned char soft_retry : 6; // Retry counter, shouldn't exceed MAX_SOFT_RETRY
+};
+
+/// @brief Communication state of calculated value, value itself is stored in result columns
+typedef struct _calculated_value calculated_value_t;
+
+_Static_assert(sizeof(calculated_value_t) == 1, "calculated_value_t is packed in single byte");
+
+#define _TF_ENUM(op, OP) TF_##OP,
+
+/// @brief Trial functions, generated from the trialfuncs library list
 enum _trial_functions
 {
     TF_UNKNOWN = -1,
-    TF_IMUL,
-    TF_IMIN,
-    TF_FMUL,
-    TF_AND,
-    TF_OR,
+    FOREACH_TRIAL_OP(_TF_ENUM)
     TF_COUNT
 };
 
@@ -54,16 +81,38 @@ enum _tf_result
     TFR_INT,
     TFR_UINT,
     TFR_FLOAT,
-    TFR_BOOL
+    TFR_BOOL,
+    TFR_COUNT
 };
 
 typedef enum _tf_result tf_result_t;
 
+// Map TYPESTR() of trialfuncs to value_t member and result type id
+#define VALUE_FIELD_int i_val
+#define VALUE_FIELD_unsigned_int ui_val
+#define VALUE_FIELD_double d_val
+#define VALUE_FIELD__Bool b_val // bool is a macro of stdbool.h
+#define RESULT_TYPE_int TFR_INT
+#define RESULT_TYPE_unsigned_int TFR_UINT
+#define RESULT_TYPE_double TFR_FLOAT
+#define RESULT_TYPE__Bool TFR_BOOL
+
+#define _VALUE_FIELD(typestr) VALUE_FIELD_##typestr
+#define VALUE_FIELD(typestr) _VALUE_FIELD(typestr)
+#define _RESULT_TYPE(typestr) RESULT_TYPE_##typestr
+#define RESULT_TYPE(typestr) _RESULT_TYPE(typestr)
+
 /// @brief Get trial function id from name
 /// @param tf Trial function name
 /// @return Trial function numerical id
 trial_function_t function_from_name(const char *tf);
 
+/// @brief Get trial function ids from comma separated names
+/// @param list  Comma separated names
+/// @param funcs Trial function ids
+/// @return Number of functions, 0 if a name is unknown or repeated
+int functions_from_list(const char *list, trial_function_t funcs[TF_COUNT]);
+
 /// @brief Get trial function name from id
 /// @param tf Trial function id
 /// @return Trial function name
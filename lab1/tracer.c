@@ -0,0 +1,167 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <trialfuncs.h>
+
+#include "tracer.h"
+
+#define TRACE_EVENTS 4096    // Events buffered before write
+#define TRACE_EVENT_JSON 192 // Space reserved for single formatted event
+
+struct _trace_event
+{
+    const char *name; // Event name, string literal
+    long long ts;     // Time, microseconds
+    char ph;          // Phase - i for instant event, b and e for begin and end of async span
+    int tid;          // Thread track
+    int x;            // Input value
+};
+
+typedef struct _trace_event trace_event_t;
+
+struct _tracer
+{
+    int fd;                                     // Trace file, opened for appending
+    int pid;                                    // Process track
+    int sample;                                 // Sample rate
+    int count;                                  // Number of buffered events
+    trace_event_t events[TRACE_EVENTS];         // Buffered events
+    char json[TRACE_EVENTS * TRACE_EVENT_JSON]; // Formatted events
+};
+
+long long trace_now()
+{
+    // Simulated time in virtual clock mode
+    return trial_clock_usecs();
+}
+
+/// @brief Append formatted text to trace file, single write keeps lines of processes apart
+static void write_json(tracer_t *t, size_t len)
+{
+    if (write(t->fd, t->json, len) != (ssize_t)len)
+    {
+        fprintf(stderr, "tracer: Write failed (%d)\n", errno);
+    }
+}
+
+static void flush_events(tracer_t *t)
+{
+    size_t len = 0;
+
+    for (int i = 0; i < t->count; i++)
+    {
+        const trace_event_t *ev = &t->events[i];
+
+        if (ev->ph == 'i')
+        {
+            len += snprintf(t->json + len, TRACE_EVENT_JSON,
+                            "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":%d,\"tid\":%d,\"args\":{\"x\":%d}},\n",
+                            ev->name, ev->ts, t->pid, ev->tid, ev->x);
+        }
+        else
+        {
+            // Spans of the same x are matched by id, spans of values in flight overlap on their own tracks
+            len += snprintf(t->json + len, TRACE_EVENT_JSON,
+                            "{\"name\":\"%s\",\"cat\":\"value\",\"ph\":\"%c\",\"id\":\"%d\",\"ts\":%lld,\"pid\":%d,\"tid\":%d,\"args\":{\"x\":%d}},\n",
+                            ev->name, ev->ph, ev->x, ev->ts, t->pid, ev->tid, ev->x);
+        }
+    }
+
+    if (len > 0)
+    {
+        write_json(t, len);
+    }
+
+    t->count = 0;
+}
+
+tracer_t *construct_tracer(const char *path, bool create, const char *name, int sample)
+{
+    tracer_t *t = malloc(sizeof(tracer_t));
+
+    if (t == NULL)
+    {
+        return NULL;
+    }
+
+    t->fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC | (create ? O_TRUNC : 0), 0644);
+
+    if (t->fd == -1)
+    {
+        fprintf(stderr, "tracer: Failed to open %s\n", path);
+        free(t);
+        return NULL;
+    }
+
+    t->pid = getpid();
+    t->sample = sample > 0 ? sample : 1;
+    t->count = 0;
+
+    size_t len = 0;
+
+    if (create)
+    {
+        len += snprintf(t->json, TRACE_EVENT_JSON, "[\n");
+    }
+
+    len += snprintf(t->json + len, TRACE_EVENT_JSON, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}},\n", t->pid, name);
+    write_json(t, len);
+
+    return t;
+}
+
+void destruct_tracer(tracer_t *t)
+{
+    flush_events(t);
+    close(t->fd);
+    free(t);
+}
+
+bool trace_sampled(const tracer_t *t, int x)
+{
+    if (t == NULL)
+    {
+        return false;
+    }
+
+    // The same x is sampled by all processes
+    unsigned int hash = (unsigned int)x * 2654435761u;
+    return (hash >> 8) % t->sample == 0;
+}
+
+static void record(tracer_t *t, int tid, const char *name, int x, long long ts, char ph)
+{
+    if (t->count == TRACE_EVENTS)
+    {
+        flush_events(t);
+    }
+
+    trace_event_t *ev = &t->events[t->count++];
+
+    ev->name = name;
+    ev->ts = ts;
+    ev->ph = ph;
+    ev->tid = tid;
+    ev->x = x;
+}
+
+void trace_instant(tracer_t *t, int tid, const char *name, int x, long long ts)
+{
+    record(t, tid, name, x, ts, 'i');
+}
+
+void trace_span(tracer_t *t, int tid, const char *name, int x, long long begin, long long end)
+{
+    record(t, tid, name, x, begin, 'b');
+    record(t, tid, name, x, end, 'e');
+}
+
+void trace_thread_name(tracer_t *t, int tid, const char *name)
+{
+    int len = snprintf(t->json, TRACE_EVENT_JSON, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", t->pid, tid, name);
+    write_json(t, len);
+}
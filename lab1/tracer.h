@@ -0,0 +1,60 @@
+#ifndef __TRACER_INC__
+#define __TRACER_INC__
+
+#include <stdbool.h>
+
+/// @brief Lifecycle tracing of input values, in Chrome trace event format.
+///
+/// Events are recorded into in-memory buffer of the process, buffer is formatted
+/// and appended to the shared trace file by single write, when it is full.
+/// Manager and calculon processes append to the same file, each process is a track.
+/// Only sampled values are traced: values, which hash of x is divisible by sample rate.
+/// File is JSON array without closing bracket, as allowed by trace event format.
+typedef struct _tracer tracer_t;
+
+/// @brief Open trace file for appending
+/// @param path   Trace file
+/// @param create Truncate file and write array opening, for the first process
+/// @param name   Process name, shown as track name
+/// @param sample Sample rate, 1 to trace every value
+/// @return Tracer instance, NULL on failure
+tracer_t *construct_tracer(const char *path, bool create, const char *name, int sample);
+
+/// @brief Write buffered events, close trace file
+/// @param t Tracer allocated by construct_tracer()
+void destruct_tracer(tracer_t *t);
+
+/// @brief Check if value is traced
+/// @param t Tracer, NULL if tracing is disabled
+/// @param x Input value
+/// @return True, if events of value should be recorded
+bool trace_sampled(const tracer_t *t, int x);
+
+/// @brief Monotonic time, shared by all processes
+/// @return Microseconds
+long long trace_now();
+
+/// @brief Record instant event
+/// @param t    Tracer
+/// @param tid  Thread track of the process
+/// @param name Event name, string literal
+/// @param x    Input value
+/// @param ts   Time, microseconds
+void trace_instant(tracer_t *t, int tid, const char *name, int x, long long ts);
+
+/// @brief Record async span, identified by x. Spans of values in flight overlap
+/// @param t     Tracer
+/// @param tid   Thread track of the process
+/// @param name  Event name, string literal
+/// @param x     Input value
+/// @param begin Start time, microseconds
+/// @param end   End time, microseconds
+void trace_span(tracer_t *t, int tid, const char *name, int x, long long begin, long long end);
+
+/// @brief Name thread track
+/// @param t    Tracer
+/// @param tid  Thread track of the process
+/// @param name Track name
+void trace_thread_name(tracer_t *t, int tid, const char *name);
+
+#endif // __TRACER_INC__
@@ -14,7 +14,10 @@ public class Common {
   }
 
   static public double R1 () {
-    java.util.Random generator = new java.util.Random(System.currentTimeMillis());
+    return R1(new java.util.Random(System.currentTimeMillis()));
+  }
+
+  static public double R1 (java.util.Random generator) {
     double U = generator.nextDouble();
     while (U < 0 || U >= 1) {
       U = generator.nextDouble();
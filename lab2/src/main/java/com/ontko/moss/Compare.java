@@ -0,0 +1,91 @@
+package com.ontko.moss;
+
+// Comparison of scheduling policies.  The same workload, read from
+// the configuration file, is simulated with every policy, results
+// are printed and written to Summary-Compare.  All processes arrive
+// at the start and I/O takes no time, so turnaround is the completion
+// time and waiting time is turnaround less CPU time.  Processes, which
+// have not completed within runtime, are counted with runtime as their
+// turnaround, so every policy is measured over the same processes and
+// its times are lower bounds, if some processes have not completed.
+
+import java.io.*;
+import java.util.Arrays;
+
+public class Compare {
+
+  private static String resultsFile = "Summary-Compare";
+
+  private static String measure(ProcessTable workload, int runtime, SchedulingPolicy policy) {
+    ProcessTable processes = workload.copy();
+    Results result = SchedulingAlgorithm.Run(runtime, processes, new Results("null","null",0), null, policy);
+
+    int size = processes.size();
+    int[] turnaround = new int[size];
+    int completed = 0;
+    double waiting = 0;
+    for (int i = 0; i < size; i++) {
+      if (processes.turnaround[i] >= 0) {
+        completed++;
+        turnaround[i] = processes.turnaround[i];
+        waiting += processes.turnaround[i] - processes.cputime[i];
+      } else {
+        turnaround[i] = runtime;
+        waiting += runtime - processes.cpudone[i];
+      }
+    }
+    Arrays.sort(turnaround);
+
+    double mean = 0;
+    for (int i = 0; i < size; i++) {
+      mean += turnaround[i];
+    }
+    mean = size > 0 ? mean / size : 0;
+    waiting = size > 0 ? waiting / size : 0;
+    int p99 = size > 0 ? turnaround[(int) Math.ceil(size * 0.99) - 1] : 0;
+    double throughput = result.compuTime > 0 ? completed * 1000.0 / result.compuTime : 0;
+
+    return String.format("%-60s\t%d/%d\t%d\t%.3f\t%.1f\t%d\t%.1f\t%d",
+        result.schedulingName, completed, size, result.compuTime, throughput, mean, p99, waiting, result.contextSwitches);
+  }
+
+  public static void main(String[] args) {
+    int quantum = args.length > 2 ? Common.s2i(args[2]) : 50;
+    File f = new File(args[1]);
+    if (!(f.exists()) || !(f.canRead())) {
+      System.out.println("Scheduling: error, read of " + f.getName() + " failed.");
+      System.exit(-1);
+    }
+    if (quantum < 1) {
+      System.out.println("Scheduling: error, invalid quantum " + args[2]);
+      System.exit(-1);
+    }
+
+    Scheduling simulation = new Scheduling();
+    simulation.Init(args[1]);
+    simulation.fill(-1);
+    ProcessTable workload = simulation.getProcesses();
+
+    SchedulingPolicy[] policies = {
+      new FirstComeFirstServed(),
+      new RoundRobin(quantum),
+      new ShortestJobFirst(),
+      new PriorityScheduling(),
+      new MultilevelFeedbackQueue(quantum, 3),
+    };
+
+    try {
+      PrintStream out = new PrintStream(new FileOutputStream(resultsFile));
+      String header = String.format("%-60s\t%s\t%s\t%s\t%s\t%s\t%s\t%s",
+          "Policy", "Completed", "Run Time (ms)", "Throughput (1/s)", "Mean Turnaround (ms)", "P99 Turnaround (ms)", "Mean Waiting (ms)", "Context Switches");
+      System.out.println(header);
+      out.println(header);
+      for (int i = 0; i < policies.length; i++) {
+        String row = measure(workload, simulation.getRuntime(), policies[i]);
+        System.out.println(row);
+        out.println(row);
+      }
+      out.close();
+    } catch (IOException e) { /* Handle exceptions */ }
+  }
+}
@@ -0,0 +1,28 @@
+package com.ontko.moss;
+
+// Pending event of the simulation.  Events are ordered by time,
+// events due at the same millisecond are handled in the order
+// of their type, as the checks of the original tick loop.
+
+public class Event implements Comparable<Event> {
+  public static final int COMPLETION = 0;
+  public static final int IO_BLOCK = 1;
+  public static final int QUANTUM = 2;
+
+  public int time;
+  public int type;
+  public int process;
+
+  public Event (int time, int type, int process) {
+    this.time = time;
+    this.type = type;
+    this.process = process;
+  }
+
+  public int compareTo(Event other) {
+    if (time != other.time) {
+      return time < other.time ? -1 : 1;
+    }
+    return type - other.type;
+  }
+}
@@ -0,0 +1,31 @@
+package com.ontko.moss;
+
+// Processes run in the order of process table, until completion
+// or I/O block.
+
+public class FirstComeFirstServed implements SchedulingPolicy {
+  private ProcessTable processes;
+
+  public String getType() {
+    return "Batch (Nonpreemptive)";
+  }
+
+  public String getName() {
+    return "First-Come First-Served";
+  }
+
+  public void start(ProcessTable processes) {
+    this.processes = processes;
+  }
+
+  public int next(int previous, int reason) {
+    if (previous < 0) {
+      return 0;
+    }
+    return processes.firstReady(reason == Event.IO_BLOCK ? previous : -1);
+  }
+
+  public int quantum(int process) {
+    return 0;
+  }
+}
@@ -0,0 +1,30 @@
+package com.ontko.moss;
+
+// FIFO of process numbers on a ring buffer.  A process is queued at
+// most once, so the number of processes bounds the capacity.
+
+public class IntQueue {
+  private int[] items;
+  private int head = 0;
+  private int size = 0;
+
+  public IntQueue(int capacity) {
+    items = new int[capacity < 1 ? 1 : capacity];
+  }
+
+  public boolean isEmpty() {
+    return size == 0;
+  }
+
+  public void add(int item) {
+    items[(head + size) % items.length] = item;
+    size++;
+  }
+
+  public int poll() {
+    int item = items[head];
+    head = (head + 1) % items.length;
+    size--;
+    return item;
+  }
+}
@@ -0,0 +1,47 @@
+package com.ontko.moss;
+
+// Policy, which runs the ready process with the lowest key, ties
+// are broken by process number.  Key of a queued process does not
+// change, only the running process accumulates CPU time.
+
+public abstract class KeyedPolicy implements SchedulingPolicy {
+  protected ProcessTable processes;
+  private LongHeap queue;
+
+  // Key of ready process, it is taken when the process is queued
+  protected abstract int key(int process);
+
+  private void add(int process) {
+    queue.add(((long) key(process) - Integer.MIN_VALUE) << 31 | process);
+  }
+
+  public void start(ProcessTable processes) {
+    this.processes = processes;
+    queue = new LongHeap(processes.size());
+    for (int i = 0; i < processes.size(); i++) {
+      if (processes.isReady(i)) {
+        add(i);
+      }
+    }
+  }
+
+  public int next(int previous, int reason) {
+    boolean requeue = previous >= 0 && processes.isReady(previous);
+    if (requeue && reason != Event.IO_BLOCK) {
+      add(previous);
+      requeue = false;
+    }
+    if (queue.isEmpty()) {
+      return requeue ? previous : -1;
+    }
+    int process = (int) (queue.poll() & Integer.MAX_VALUE);
+    if (requeue) {
+      add(previous);
+    }
+    return process;
+  }
+
+  public int quantum(int process) {
+    return 0;
+  }
+}
@@ -0,0 +1,49 @@
+package com.ontko.moss;
+
+// Binary min-heap of long keys on an array.  A process is queued at
+// most once, so the number of processes bounds the capacity.
+
+public class LongHeap {
+  private long[] items;
+  private int size = 0;
+
+  public LongHeap(int capacity) {
+    items = new long[capacity < 1 ? 1 : capacity];
+  }
+
+  public boolean isEmpty() {
+    return size == 0;
+  }
+
+  public void add(long item) {
+    int i = size++;
+    while (i > 0) {
+      int parent = (i - 1) / 2;
+      if (items[parent] <= item) {
+        break;
+      }
+      items[i] = items[parent];
+      i = parent;
+    }
+    items[i] = item;
+  }
+
+  public long poll() {
+    long top = items[0];
+    long item = items[--size];
+    int i = 0;
+    while (2 * i + 1 < size) {
+      int child = 2 * i + 1;
+      if (child + 1 < size && items[child + 1] < items[child]) {
+        child++;
+      }
+      if (item <= items[child]) {
+        break;
+      }
+      items[i] = items[child];
+      i = child;
+    }
+    items[i] = item;
+    return top;
+  }
+}
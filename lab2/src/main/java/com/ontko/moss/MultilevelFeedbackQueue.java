@@ -0,0 +1,67 @@
+package com.ontko.moss;
+
+// Multilevel feedback queue.  Processes start at the top level,
+// the quantum doubles with every level down.  A process, which
+// uses up its quantum, moves one level down, a process blocked
+// by I/O keeps its level.  The highest non-empty level runs first.
+
+public class MultilevelFeedbackQueue implements SchedulingPolicy {
+  private int quantum;
+  private int levels;
+  private ProcessTable processes;
+  private IntQueue[] queues;
+  private int[] level;
+
+  public MultilevelFeedbackQueue(int quantum, int levels) {
+    this.quantum = quantum;
+    this.levels = levels;
+  }
+
+  public String getType() {
+    return "Interactive (Preemptive)";
+  }
+
+  public String getName() {
+    return "Multilevel Feedback Queue, " + levels + " levels, quantum " + quantum + " ms";
+  }
+
+  public void start(ProcessTable processes) {
+    this.processes = processes;
+    queues = new IntQueue[levels];
+    for (int i = 0; i < levels; i++) {
+      queues[i] = new IntQueue(processes.size());
+    }
+    level = new int[processes.size()];
+    for (int i = 0; i < processes.size(); i++) {
+      if (processes.isReady(i)) {
+        queues[0].add(i);
+      }
+    }
+  }
+
+  public int next(int previous, int reason) {
+    boolean requeue = previous >= 0 && processes.isReady(previous);
+    if (requeue && reason != Event.IO_BLOCK) {
+      if (reason == Event.QUANTUM && level[previous] < levels - 1) {
+        level[previous]++;
+      }
+      queues[level[previous]].add(previous);
+      requeue = false;
+    }
+    int process = requeue ? previous : -1;
+    for (int i = 0; i < levels; i++) {
+      if (!queues[i].isEmpty()) {
+        process = queues[i].poll();
+        break;
+      }
+    }
+    if (requeue && process != previous) {
+      queues[level[previous]].add(previous);
+    }
+    return process;
+  }
+
+  public int quantum(int process) {
+    return quantum << level[process];
+  }
+}
@@ -0,0 +1,20 @@
+package com.ontko.moss;
+
+// The ready process with the lowest value of priority runs first,
+// priority is set by the second field of process line of
+// configuration file.
+
+public class PriorityScheduling extends KeyedPolicy {
+
+  public String getType() {
+    return "Batch (Nonpreemptive)";
+  }
+
+  public String getName() {
+    return "Priority";
+  }
+
+  protected int key(int process) {
+    return processes.priority[process];
+  }
+}
@@ -0,0 +1,112 @@
+package com.ontko.moss;
+
+// Process table.  Fields of processes are kept in parallel primitive
+// arrays, indexed by process number, so a million processes take a
+// few arrays instead of a million objects.  Processes which have not
+// completed their CPU time are indexed by the ready set, the lowest
+// ready process is found without a scan of the whole table.  Bits of
+// the ready set are only cleared after add, so the search starts from
+// the lowest ready process found before.
+
+import java.util.Arrays;
+import java.util.BitSet;
+
+public class ProcessTable {
+  public int[] cputime;
+  public int[] ioblocking;
+  public int[] cpudone;
+  public int[] ionext;
+  public int[] numblocked;
+  public int[] priority;
+  public int[] turnaround;
+  private int size = 0;
+  private BitSet ready = new BitSet();
+  private int lowReady = 0;
+
+  public ProcessTable() {
+    this(16);
+  }
+
+  public ProcessTable(int capacity) {
+    if (capacity < 1) {
+      capacity = 1;
+    }
+    cputime = new int[capacity];
+    ioblocking = new int[capacity];
+    cpudone = new int[capacity];
+    ionext = new int[capacity];
+    numblocked = new int[capacity];
+    priority = new int[capacity];
+    turnaround = new int[capacity];
+  }
+
+  public int size() {
+    return size;
+  }
+
+  public void add(int cputime, int ioblocking, int cpudone, int ionext, int numblocked) {
+    add(cputime, ioblocking, cpudone, ionext, numblocked, 0);
+  }
+
+  // Lower value of priority is served first.  Turnaround is the
+  // completion time, all processes arrive at the start, it is -1
+  // until the process completes.
+  public void add(int cputime, int ioblocking, int cpudone, int ionext, int numblocked, int priority) {
+    if (size == this.cputime.length) {
+      int capacity = size * 2;
+      this.cputime = Arrays.copyOf(this.cputime, capacity);
+      this.ioblocking = Arrays.copyOf(this.ioblocking, capacity);
+      this.cpudone = Arrays.copyOf(this.cpudone, capacity);
+      this.ionext = Arrays.copyOf(this.ionext, capacity);
+      this.numblocked = Arrays.copyOf(this.numblocked, capacity);
+      this.priority = Arrays.copyOf(this.priority, capacity);
+      this.turnaround = Arrays.copyOf(this.turnaround, capacity);
+    }
+    this.cputime[size] = cputime;
+    this.ioblocking[size] = ioblocking;
+    this.cpudone[size] = cpudone;
+    this.ionext[size] = ionext;
+    this.numblocked[size] = numblocked;
+    this.priority[size] = priority;
+    this.turnaround[size] = -1;
+    if (cpudone < cputime) {
+      ready.set(size);
+    }
+    size++;
+  }
+
+  // Runs process for ticks milliseconds, it leaves the ready set,
+  // when its CPU time is completed
+  public void run(int i, int ticks) {
+    cpudone[i] += ticks;
+    if (ioblocking[i] > 0) {
+      ionext[i] += ticks;
+    }
+    if (cpudone[i] >= cputime[i]) {
+      ready.clear(i);
+    }
+  }
+
+  // Copy of the table, the same workload for another simulation
+  public ProcessTable copy() {
+    ProcessTable table = new ProcessTable(size);
+    for (int i = 0; i < size; i++) {
+      table.add(cputime[i], ioblocking[i], cpudone[i], ionext[i], numblocked[i], priority[i]);
+    }
+    return table;
+  }
+
+  public boolean isReady(int i) {
+    return ready.get(i);
+  }
+
+  // The lowest ready process other than except, -1 if there is none
+  public int firstReady(int except) {
+    int i = ready.nextSetBit(lowReady);
+    lowReady = i < 0 ? size : i;
+    if (i == except && i >= 0) {
+      i = ready.nextSetBit(i + 1);
+    }
+    return i;
+  }
+}
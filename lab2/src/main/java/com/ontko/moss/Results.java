@@ -4,6 +4,7 @@ public class Results {
   public String schedulingType;
   public String schedulingName;
   public int compuTime;
+  public int contextSwitches = 0;
 
   public Results (String schedulingType, String schedulingName, int compuTime) {
     this.schedulingType = schedulingType;
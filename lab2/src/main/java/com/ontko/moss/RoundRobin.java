@@ -0,0 +1,43 @@
+package com.ontko.moss;
+
+// Ready processes take turns in FIFO order, every one runs for
+// the quantum at most, then it is placed to the tail of the queue.
+
+public class RoundRobin implements SchedulingPolicy {
+  private int quantum;
+  private ProcessTable processes;
+  private IntQueue queue;
+
+  public RoundRobin(int quantum) {
+    this.quantum = quantum;
+  }
+
+  public String getType() {
+    return "Interactive (Preemptive)";
+  }
+
+  public String getName() {
+    return "Round-Robin, quantum " + quantum + " ms";
+  }
+
+  public void start(ProcessTable processes) {
+    this.processes = processes;
+    queue = new IntQueue(processes.size());
+    for (int i = 0; i < processes.size(); i++) {
+      if (processes.isReady(i)) {
+        queue.add(i);
+      }
+    }
+  }
+
+  public int next(int previous, int reason) {
+    if (previous >= 0 && processes.isReady(previous)) {
+      queue.add(previous);
+    }
+    return queue.isEmpty() ? -1 : queue.poll();
+  }
+
+  public int quantum(int process) {
+    return quantum;
+  }
+}
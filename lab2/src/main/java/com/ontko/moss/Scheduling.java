@@ -7,6 +7,9 @@ package com.ontko.moss;
 // is where the summary results are written, and Summary-Processes
 // is where the process scheduling summary is written.
 
+// State of the simulation belongs to the instance, so Sweep runs
+// many simulations in parallel within one JVM.
+
 // Created by Alexander Reeder, 2001 January 06
 
 import java.io.*;
@@ -14,23 +17,59 @@ import java.util.*;
 
 public class Scheduling {
 
-  private static int processnum = 5;
-  private static int meanDev = 1000;
-  private static int standardDev = 100;
-  private static int runtime = 1000;
-  private static Vector processVector = new Vector();
-  private static Results result = new Results("null","null",0);
+  private int processnum = 5;
+  private int meanDev = 1000;
+  private int standardDev = 100;
+  private int runtime = 1000;
+  private ProcessTable processes = new ProcessTable();
+  private Results result = new Results("null","null",0);
+  private Random generator = new Random(System.currentTimeMillis());
   private static String resultsFile = "Summary-Results";
 
-  private static void Init(String file) {
+  public Scheduling() {
+  }
+
+  // Simulation without configuration file, CPU time of processes
+  // is drawn from generator
+  public Scheduling(int processnum, int meanDev, int standardDev, int runtime, Random generator) {
+    this.processnum = processnum;
+    this.meanDev = meanDev;
+    this.standardDev = standardDev;
+    this.runtime = runtime;
+    this.generator = generator;
+    this.processes = new ProcessTable(processnum);
+  }
+
+  public ProcessTable getProcesses() {
+    return processes;
+  }
+
+  public int getRuntime() {
+    return runtime;
+  }
+
+  public Results getResult() {
+    return result;
+  }
+
+  private int nextCputime() {
+    double X = Common.R1(generator);
+    while (X == -1.0) {
+      X = Common.R1(generator);
+    }
+    X = X * standardDev;
+    return (int) X + meanDev;
+  }
+
+  void Init(String file) {
     File f = new File(file);
     String line;
     String tmp;
     int cputime = 0;
     int ioblocking = 0;
-    double X = 0.0;
+    int priority = 0;
 
-    try {   
+    try {
       //BufferedReader in = new BufferedReader(new FileReader(f));
       DataInputStream in = new DataInputStream(new FileInputStream(f));
       while ((line = in.readLine()) != null) {
@@ -53,13 +92,9 @@ public class Scheduling {
           StringTokenizer st = new StringTokenizer(line);
           st.nextToken();
           ioblocking = Common.s2i(st.nextToken());
-          X = Common.R1();
-          while (X == -1.0) {
-            X = Common.R1();
-          }
-          X = X * standardDev;
-          cputime = (int) X + meanDev;
-          processVector.addElement(new sProcess(cputime, ioblocking, 0, 0, 0));          
+          priority = st.hasMoreTokens() ? Common.s2i(st.nextToken()) : 0;
+          cputime = nextCputime();
+          processes.add(cputime, ioblocking, 0, 0, 0, priority);
         }
         if (line.startsWith("runtime")) {
           StringTokenizer st = new StringTokenizer(line);
@@ -71,76 +106,93 @@ public class Scheduling {
     } catch (IOException e) { /* Handle exceptions */ }
   }
 
-  private static void debug() {
+  // Adds processes up to numprocess, I/O blocking of added process
+  // is ioblocking, or i * 100 for negative ioblocking
+  public void fill(int ioblocking) {
+    int i = 0;
+    while (processes.size() < processnum) {
+      int cputime = nextCputime();
+      processes.add(cputime, ioblocking < 0 ? i * 100 : ioblocking, 0, 0, 0);
+      i++;
+    }
+  }
+
+  // Process scheduling summary is written to processesFile, if it is not null
+  public Results run(String processesFile) {
+    result = SchedulingAlgorithm.Run(runtime, processes, result, processesFile);
+    return result;
+  }
+
+  private void debug() {
     int i = 0;
 
     System.out.println("processnum " + processnum);
     System.out.println("meandevm " + meanDev);
     System.out.println("standdev " + standardDev);
-    int size = processVector.size();
+    int size = processes.size();
     for (i = 0; i < size; i++) {
-      sProcess process = (sProcess) processVector.elementAt(i);
-      System.out.println("process " + i + " " + process.cputime + " " + process.ioblocking + " " + process.cpudone + " " + process.numblocked);
+      System.out.println("process " + i + " " + processes.cputime[i] + " " + processes.ioblocking[i] + " " + processes.cpudone[i] + " " + processes.numblocked[i]);
     }
     System.out.println("runtime " + runtime);
   }
 
-  public static void main(String[] args) {
+  private void report(String file) {
     int i = 0;
 
-    if (args.length != 1) {
-      System.out.println("Usage: 'java Scheduling <INIT FILE>'");
-      System.exit(-1);
-    }
-    File f = new File(args[0]);
-    if (!(f.exists())) {
-      System.out.println("Scheduling: error, file '" + f.getName() + "' does not exist.");
-      System.exit(-1);
-    }  
-    if (!(f.canRead())) {
-      System.out.println("Scheduling: error, read of " + f.getName() + " failed.");
-      System.exit(-1);
-    }
-    System.out.println("Working...");
-    Init(args[0]);
-    if (processVector.size() < processnum) {
-      i = 0;
-      while (processVector.size() < processnum) {       
-          double X = Common.R1();
-          while (X == -1.0) {
-            X = Common.R1();
-          }
-          X = X * standardDev;
-        int cputime = (int) X + meanDev;
-        processVector.addElement(new sProcess(cputime,i*100,0,0,0));          
-        i++;
-      }
-    }
-    result = SchedulingAlgorithm.Run(runtime, processVector, result);    
     try {
       //BufferedWriter out = new BufferedWriter(new FileWriter(resultsFile));
-      PrintStream out = new PrintStream(new FileOutputStream(resultsFile));
+      PrintStream out = new PrintStream(new BufferedOutputStream(new FileOutputStream(file)));
       out.println("Scheduling Type: " + result.schedulingType);
       out.println("Scheduling Name: " + result.schedulingName);
       out.println("Simulation Run Time: " + result.compuTime);
       out.println("Mean: " + meanDev);
       out.println("Standard Deviation: " + standardDev);
       out.println("Process #\tCPU Time\tIO Blocking\tCPU Completed\tCPU Blocked");
-      for (i = 0; i < processVector.size(); i++) {
-        sProcess process = (sProcess) processVector.elementAt(i);
+      for (i = 0; i < processes.size(); i++) {
         out.print(Integer.toString(i));
         if (i < 100) { out.print("\t\t"); } else { out.print("\t"); }
-        out.print(Integer.toString(process.cputime));
-        if (process.cputime < 100) { out.print(" (ms)\t\t"); } else { out.print(" (ms)\t"); }
-        out.print(Integer.toString(process.ioblocking));
-        if (process.ioblocking < 100) { out.print(" (ms)\t\t"); } else { out.print(" (ms)\t"); }
-        out.print(Integer.toString(process.cpudone));
-        if (process.cpudone < 100) { out.print(" (ms)\t\t"); } else { out.print(" (ms)\t"); }
-        out.println(process.numblocked + " times");
+        out.print(Integer.toString(processes.cputime[i]));
+        if (processes.cputime[i] < 100) { out.print(" (ms)\t\t"); } else { out.print(" (ms)\t"); }
+        out.print(Integer.toString(processes.ioblocking[i]));
+        if (processes.ioblocking[i] < 100) { out.print(" (ms)\t\t"); } else { out.print(" (ms)\t"); }
+        out.print(Integer.toString(processes.cpudone[i]));
+        if (processes.cpudone[i] < 100) { out.print(" (ms)\t\t"); } else { out.print(" (ms)\t"); }
+        out.println(processes.numblocked[i] + " times");
       }
       out.close();
     } catch (IOException e) { /* Handle exceptions */ }
-  System.out.println("Completed.");
   }
-}
 
+  public static void main(String[] args) {
+    if (args.length >= 2 && args.length <= 3 && args[0].equals("-sweep")) {
+      Sweep.main(args);
+      return;
+    }
+    if (args.length >= 2 && args.length <= 3 && args[0].equals("-compare")) {
+      Compare.main(args);
+      return;
+    }
+    if (args.length != 1) {
+      System.out.println("Usage: 'java Scheduling <INIT FILE>'");
+      System.out.println("       'java Scheduling -sweep <SWEEP FILE> [<RESULT FILE>]'");
+      System.out.println("       'java Scheduling -compare <INIT FILE> [<QUANTUM>]'");
+      System.exit(-1);
+    }
+    File f = new File(args[0]);
+    if (!(f.exists())) {
+      System.out.println("Scheduling: error, file '" + f.getName() + "' does not exist.");
+      System.exit(-1);
+    }
+    if (!(f.canRead())) {
+      System.out.println("Scheduling: error, read of " + f.getName() + " failed.");
+      System.exit(-1);
+    }
+    System.out.println("Working...");
+    Scheduling simulation = new Scheduling();
+    simulation.Init(args[0]);
+    simulation.fill(-1);
+    simulation.run("Summary-Processes");
+    simulation.report(resultsFile);
+    System.out.println("Completed.");
+  }
+}
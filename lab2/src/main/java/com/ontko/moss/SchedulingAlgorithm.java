@@ -4,67 +4,124 @@ package com.ontko.moss;
 // the scheduling algorithm written by the user resides.
 // User modification should occur within the Run() function.
 
-import java.util.Vector;
+// The simulation is event driven.  Completion and I/O block of
+// the running process are kept in a priority queue and time jumps
+// directly from one event to the next one, the running process
+// accumulates CPU time of the whole interval at once.  Blocked
+// process is ready again at once, it is only skipped by the next
+// choice, so there is no separate unblock event.  The next process
+// is chosen by SchedulingPolicy, First-Come First-Served by default,
+// preemptive policies add expiry of the quantum to the events.
+
+import java.util.PriorityQueue;
 import java.io.*;
 
 public class SchedulingAlgorithm {
 
-  public static Results Run(int runtime, Vector processVector, Results result) {
-    int i = 0;
+  private static void log(PrintStream out, String state, int currentProcess, ProcessTable processes) {
+    if (out == null) {
+      return;
+    }
+    int i = currentProcess;
+    out.println("Process: " + i + " " + state + "... (" + processes.cputime[i] + " " + processes.ioblocking[i] + " " + processes.cpudone[i] + " " + processes.cpudone[i] + ")");
+  }
+
+  // Schedules events of the process, registered at comptime.  The tick
+  // loop checked completion and I/O block once per millisecond, so a
+  // check already made at comptime is not repeated.
+  private static void dispatch(PriorityQueue<Event> events, int currentProcess, ProcessTable processes, int comptime, boolean completionChecked, boolean blockChecked, int quantum) {
+    int i = currentProcess;
+    events.clear();
+    int left = processes.cputime[i] - processes.cpudone[i];
+    if (left > 0 || (left == 0 && !completionChecked)) {
+      events.add(new Event(comptime + left, Event.COMPLETION, i));
+    }
+    int blockIn = processes.ioblocking[i] > 0 ? processes.ioblocking[i] - processes.ionext[i] : 0;
+    if (blockChecked && blockIn < 1) {
+      blockIn = 1;
+    }
+    events.add(new Event(comptime + blockIn, Event.IO_BLOCK, i));
+    if (quantum > 0) {
+      events.add(new Event(comptime + quantum, Event.QUANTUM, i));
+    }
+  }
+
+  public static Results Run(int runtime, ProcessTable processes, Results result) {
+    return Run(runtime, processes, result, "Summary-Processes");
+  }
+
+  // Process scheduling summary is not written, if resultsFile is null
+  public static Results Run(int runtime, ProcessTable processes, Results result, String resultsFile) {
+    return Run(runtime, processes, result, resultsFile, new FirstComeFirstServed());
+  }
+
+  public static Results Run(int runtime, ProcessTable processes, Results result, String resultsFile, SchedulingPolicy policy) {
+    int next = 0;
     int comptime = 0;
     int currentProcess = 0;
-    int previousProcess = 0;
-    int size = processVector.size();
+    int size = processes.size();
     int completed = 0;
-    String resultsFile = "Summary-Processes";
+    PriorityQueue<Event> events = new PriorityQueue<Event>();
 
-    result.schedulingType = "Batch (Nonpreemptive)";
-    result.schedulingName = "First-Come First-Served"; 
+    result.schedulingType = policy.getType();
+    result.schedulingName = policy.getName();
+    result.contextSwitches = 0;
+    if (size == 0) {
+      result.compuTime = 0;
+      return result;
+    }
     try {
       //BufferedWriter out = new BufferedWriter(new FileWriter(resultsFile));
       //OutputStream out = new FileOutputStream(resultsFile);
-      PrintStream out = new PrintStream(new FileOutputStream(resultsFile));
-      sProcess process = (sProcess) processVector.elementAt(currentProcess);
-      out.println("Process: " + currentProcess + " registered... (" + process.cputime + " " + process.ioblocking + " " + process.cpudone + " " + process.cpudone + ")");
-      while (comptime < runtime) {
-        if (process.cpudone == process.cputime) {
+      PrintStream out = null;
+      if (resultsFile != null) {
+        out = new PrintStream(new BufferedOutputStream(new FileOutputStream(resultsFile)));
+      }
+      policy.start(processes);
+      next = policy.next(-1, -1);
+      if (next >= 0) {
+        currentProcess = next;
+      }
+      log(out, "registered", currentProcess, processes);
+      dispatch(events, currentProcess, processes, comptime, false, false, policy.quantum(currentProcess));
+      while (!events.isEmpty() && events.peek().time < runtime) {
+        Event event = events.poll();
+        processes.run(currentProcess, event.time - comptime);
+        comptime = event.time;
+        if (event.type == Event.COMPLETION) {
           completed++;
-          out.println("Process: " + currentProcess + " completed... (" + process.cputime + " " + process.ioblocking + " " + process.cpudone + " " + process.cpudone + ")");
+          processes.turnaround[currentProcess] = comptime;
+          log(out, "completed", currentProcess, processes);
           if (completed == size) {
             result.compuTime = comptime;
-            out.close();
-            return result;
-          }
-          for (i = size - 1; i >= 0; i--) {
-            process = (sProcess) processVector.elementAt(i);
-            if (process.cpudone < process.cputime) { 
-              currentProcess = i;
-            }
-          }
-          process = (sProcess) processVector.elementAt(currentProcess);
-          out.println("Process: " + currentProcess + " registered... (" + process.cputime + " " + process.ioblocking + " " + process.cpudone + " " + process.cpudone + ")");
-        }      
-        if (process.ioblocking == process.ionext) {
-          out.println("Process: " + currentProcess + " I/O blocked... (" + process.cputime + " " + process.ioblocking + " " + process.cpudone + " " + process.cpudone + ")");
-          process.numblocked++;
-          process.ionext = 0; 
-          previousProcess = currentProcess;
-          for (i = size - 1; i >= 0; i--) {
-            process = (sProcess) processVector.elementAt(i);
-            if (process.cpudone < process.cputime && previousProcess != i) { 
-              currentProcess = i;
+            if (out != null) {
+              out.close();
             }
+            return result;
           }
-          process = (sProcess) processVector.elementAt(currentProcess);
-          out.println("Process: " + currentProcess + " registered... (" + process.cputime + " " + process.ioblocking + " " + process.cpudone + " " + process.cpudone + ")");
-        }        
-        process.cpudone++;       
-        if (process.ioblocking > 0) {
-          process.ionext++;
+        } else if (event.type == Event.IO_BLOCK) {
+          log(out, "I/O blocked", currentProcess, processes);
+          processes.numblocked[currentProcess]++;
+          processes.ionext[currentProcess] = 0;
+        } else {
+          log(out, "preempted", currentProcess, processes);
+        }
+        next = policy.next(currentProcess, event.type);
+        if (next >= 0 && next != currentProcess) {
+          currentProcess = next;
+          result.contextSwitches++;
         }
-        comptime++;
+        log(out, "registered", currentProcess, processes);
+        // Checks of earlier types at comptime are made, a process taken after completion may block at once
+        dispatch(events, currentProcess, processes, comptime, true, event.type != Event.COMPLETION, policy.quantum(currentProcess));
+      }
+      if (comptime < runtime) {
+        processes.run(currentProcess, runtime - comptime);
+        comptime = runtime;
+      }
+      if (out != null) {
+        out.close();
       }
-      out.close();
     } catch (IOException e) { /* Handle exceptions */ }
     result.compuTime = comptime;
     return result;
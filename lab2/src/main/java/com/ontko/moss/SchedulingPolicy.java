@@ -0,0 +1,24 @@
+package com.ontko.moss;
+
+// Scheduling policy, chooses the next process for
+// SchedulingAlgorithm.Run().  The process, which has just been
+// blocked by I/O, is skipped by the next choice, if there is any
+// other ready process, as blocked processes are ready again at once.
+
+public interface SchedulingPolicy {
+
+  public String getType();
+
+  public String getName();
+
+  // Called once before simulation
+  public void start(ProcessTable processes);
+
+  // Process to run, when previous process completed, blocked or its
+  // quantum expired, reason is the type of that event.  Previous is
+  // -1 for the first choice.  Returns -1, if there is no ready process.
+  public int next(int previous, int reason);
+
+  // Time slice of process, 0 if it runs until completion or I/O block
+  public int quantum(int process);
+}
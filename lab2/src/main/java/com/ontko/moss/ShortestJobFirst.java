@@ -0,0 +1,21 @@
+package com.ontko.moss;
+
+// The ready process with the least CPU time left runs first, until
+// it completes or blocks.  All processes arrive at the start and the
+// running process only gets shorter, so preemption by Shortest
+// Remaining Time First would make the same choices.
+
+public class ShortestJobFirst extends KeyedPolicy {
+
+  public String getType() {
+    return "Batch (Nonpreemptive)";
+  }
+
+  public String getName() {
+    return "Shortest Job First";
+  }
+
+  protected int key(int process) {
+    return processes.cputime[process] - processes.cpudone[process];
+  }
+}
@@ -0,0 +1,175 @@
+package com.ontko.moss;
+
+// Parameter sweep.  The sweep file gives ranges of simulation
+// parameters, every combination of them is simulated once, in
+// parallel on all cores, and results are written to one table
+// in the order of combinations.
+//
+//   numprocess <from> [<to> [<step>]]
+//   meandev    <from> [<to> [<step>]]
+//   standdev   <from> [<to> [<step>]]
+//   runtime    <from> [<to> [<step>]]
+//   ioblocking <from> [<to> [<step>]]
+//   seed       <seed>
+//   threads    <threads>
+//
+// CPU time of processes is drawn from a generator seeded by seed
+// and the number of combination, so the table does not depend on
+// the number of threads.  As in the tick loop, ioblocking 0 blocks
+// the process after every millisecond of CPU time.
+
+import java.io.*;
+import java.util.*;
+import java.util.concurrent.*;
+
+public class Sweep {
+
+  private static final int NUMPROCESS = 0;
+  private static final int MEANDEV = 1;
+  private static final int STANDDEV = 2;
+  private static final int RUNTIME = 3;
+  private static final int IOBLOCKING = 4;
+  private static final String[] names = { "numprocess", "meandev", "standdev", "runtime", "ioblocking" };
+
+  private int[][] ranges = { { 5, 5, 1 }, { 1000, 1000, 1 }, { 100, 100, 1 }, { 1000, 1000, 1 }, { 100, 100, 1 } };
+  private long seed = 25;
+  private int threads = Runtime.getRuntime().availableProcessors();
+
+  private void Init(String file) throws IOException {
+    String line;
+
+    BufferedReader in = new BufferedReader(new FileReader(file));
+    while ((line = in.readLine()) != null) {
+      StringTokenizer st = new StringTokenizer(line);
+      if (!st.hasMoreTokens()) {
+        continue;
+      }
+      String key = st.nextToken();
+      for (int i = 0; i < names.length; i++) {
+        if (key.equals(names[i]) && st.hasMoreTokens()) {
+          ranges[i][0] = Common.s2i(st.nextToken());
+          ranges[i][1] = st.hasMoreTokens() ? Common.s2i(st.nextToken()) : ranges[i][0];
+          ranges[i][2] = st.hasMoreTokens() ? Common.s2i(st.nextToken()) : 1;
+        }
+      }
+      if (key.equals("seed") && st.hasMoreTokens()) {
+        seed = Common.s2i(st.nextToken());
+      }
+      if (key.equals("threads") && st.hasMoreTokens()) {
+        threads = Common.s2i(st.nextToken());
+      }
+    }
+    in.close();
+  }
+
+  private static int steps(int[] range) {
+    if (range[2] <= 0 || range[1] < range[0]) {
+      return 1;
+    }
+    return (range[1] - range[0]) / range[2] + 1;
+  }
+
+  // Parameters of combination, the last parameter changes first
+  private int[] combination(long index) {
+    int[] values = new int[names.length];
+    for (int i = names.length - 1; i >= 0; i--) {
+      int n = steps(ranges[i]);
+      values[i] = ranges[i][0] + (int) (index % n) * ranges[i][2];
+      index /= n;
+    }
+    return values;
+  }
+
+  private static String simulate(int[] values, long seed) {
+    Scheduling simulation = new Scheduling(values[NUMPROCESS], values[MEANDEV], values[STANDDEV], values[RUNTIME], new Random(seed));
+    simulation.fill(values[IOBLOCKING]);
+    Results result = simulation.run(null);
+
+    ProcessTable processes = simulation.getProcesses();
+    int completed = 0;
+    long cpudone = 0;
+    long blocked = 0;
+    for (int i = 0; i < processes.size(); i++) {
+      if (processes.cpudone[i] >= processes.cputime[i]) {
+        completed++;
+      }
+      cpudone += processes.cpudone[i];
+      blocked += processes.numblocked[i];
+    }
+
+    StringBuilder row = new StringBuilder();
+    for (int i = 0; i < values.length; i++) {
+      row.append(values[i]).append('\t');
+    }
+    row.append(result.compuTime).append('\t').append(completed).append('\t').append(cpudone).append('\t').append(blocked);
+    return row.toString();
+  }
+
+  public static void main(String[] args) {
+    String sweepFile = args[1];
+    String tableFile = args.length > 2 ? args[2] : "Summary-Sweep";
+    Sweep sweep = new Sweep();
+
+    try {
+      sweep.Init(sweepFile);
+    } catch (IOException e) {
+      System.out.println("Scheduling: error, read of " + sweepFile + " failed.");
+      System.exit(-1);
+    }
+
+    long count = 1;
+    for (int i = 0; i < names.length; i++) {
+      count *= steps(sweep.ranges[i]);
+    }
+    if (sweep.threads < 1 || sweep.ranges[NUMPROCESS][0] < 1) {
+      System.out.println("Scheduling: error, invalid sweep " + sweepFile);
+      System.exit(-1);
+    }
+
+    System.out.println("Working... " + count + " simulations, " + sweep.threads + " threads");
+    ExecutorService pool = Executors.newFixedThreadPool(sweep.threads);
+    PrintStream out = null;
+    boolean failed = true;
+    try {
+      out = new PrintStream(new BufferedOutputStream(new FileOutputStream(tableFile)));
+      out.println("numprocess\tmeandev\tstanddev\truntime\tioblocking\tsimulated\tcompleted\tcpudone\tblocked");
+
+      // Submitted ahead of writing by a bounded window, rows are written in order
+      ArrayDeque<Future<String>> window = new ArrayDeque<Future<String>>();
+      long next = 0;
+      while (next < count || !window.isEmpty()) {
+        while (next < count && window.size() < sweep.threads * 4) {
+          final int[] values = sweep.combination(next);
+          final long simulationSeed = sweep.seed * 1000003 + next;
+          window.add(pool.submit(new Callable<String>() {
+            public String call() {
+              return simulate(values, simulationSeed);
+            }
+          }));
+          next++;
+        }
+        out.println(window.poll().get());
+      }
+      out.flush();
+      if (out.checkError()) {
+        throw new IOException(tableFile);
+      }
+      failed = false;
+    } catch (IOException e) {
+      System.out.println("Scheduling: error, write of " + tableFile + " failed.");
+    } catch (InterruptedException e) {
+      System.out.println("Scheduling: sweep is interrupted.");
+    } catch (ExecutionException e) {
+      System.out.println("Scheduling: simulation failed - " + e.getCause());
+    } finally {
+      if (out != null) {
+        out.close();
+      }
+      pool.shutdownNow();
+    }
+    if (failed) {
+      System.exit(-1);
+    }
+    System.out.println("Completed.");
+  }
+}
@@ -0,0 +1,88 @@
+package com.ontko.moss;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+
+import java.util.Arrays;
+import java.util.Random;
+
+import org.junit.Test;
+
+/**
+ * Event engine against the original loop, which runs one tick at a time.
+ */
+public class SchedulingAlgorithmTest
+{
+  // Original tick loop of SchedulingAlgorithm, first come first served
+  private static int tickRun(int runtime, ProcessTable processes) {
+    int size = processes.size();
+    int comptime = 0;
+    int currentProcess = 0;
+    int previousProcess = 0;
+    int completed = 0;
+
+    while (comptime < runtime) {
+      if (processes.cpudone[currentProcess] == processes.cputime[currentProcess]) {
+        completed++;
+        if (completed == size) {
+          return comptime;
+        }
+        for (int i = size - 1; i >= 0; i--) {
+          if (processes.cpudone[i] < processes.cputime[i]) {
+            currentProcess = i;
+          }
+        }
+      }
+      if (processes.ioblocking[currentProcess] == processes.ionext[currentProcess]) {
+        processes.numblocked[currentProcess]++;
+        processes.ionext[currentProcess] = 0;
+        previousProcess = currentProcess;
+        for (int i = size - 1; i >= 0; i--) {
+          if (processes.cpudone[i] < processes.cputime[i] && previousProcess != i) {
+            currentProcess = i;
+          }
+        }
+      }
+      processes.cpudone[currentProcess]++;
+      if (processes.ioblocking[currentProcess] > 0) {
+        processes.ionext[currentProcess]++;
+      }
+      comptime++;
+    }
+    return comptime;
+  }
+
+  private static void assertColumn(String name, int[] expected, int[] actual, int size) {
+    assertArrayEquals(name, Arrays.copyOf(expected, size), Arrays.copyOf(actual, size));
+  }
+
+  @Test
+  public void eventsMatchTickLoop()
+  {
+    Random random = new Random(25);
+
+    for (int trial = 0; trial < 2000; trial++) {
+      int size = 1 + random.nextInt(6);
+      int runtime = 1 + random.nextInt(300);
+      ProcessTable processes = new ProcessTable();
+
+      for (int i = 0; i < size; i++) {
+        // CPU time of zero or less completes at once, blocking of
+        // zero blocks after every millisecond
+        int cputime = random.nextInt(4) == 0 ? -random.nextInt(4) : 1 + random.nextInt(60);
+        int ioblocking = random.nextInt(4) == 0 ? 0 : 1 + random.nextInt(40);
+        processes.add(cputime, ioblocking, 0, 0, 0);
+      }
+
+      ProcessTable reference = processes.copy();
+      int expected = tickRun(runtime, reference);
+      Results result = SchedulingAlgorithm.Run(runtime, processes, new Results("", "", 0), null, new FirstComeFirstServed());
+      String trialName = "trial " + trial;
+
+      assertEquals(trialName, expected, result.compuTime);
+      assertColumn(trialName + " cpudone", reference.cpudone, processes.cpudone, size);
+      assertColumn(trialName + " ionext", reference.ionext, processes.ionext, size);
+      assertColumn(trialName + " numblocked", reference.numblocked, processes.numblocked, size);
+    }
+  }
+}
@@ -0,0 +1,63 @@
+package com.ontko.moss;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+
+import java.util.Arrays;
+
+import org.junit.Test;
+
+/**
+ * Policies on a workload of three processes, which never block:
+ * CPU time 30, 10 and 20 ms, priority 1, 3 and 2.
+ */
+public class SchedulingPolicyTest
+{
+  private static ProcessTable workload() {
+    ProcessTable processes = new ProcessTable();
+    processes.add(30, 1000, 0, 0, 0, 1);
+    processes.add(10, 1000, 0, 0, 0, 3);
+    processes.add(20, 1000, 0, 0, 0, 2);
+    return processes;
+  }
+
+  private static void check(SchedulingPolicy policy, int switches, int[] turnaround) {
+    ProcessTable processes = workload();
+    Results result = SchedulingAlgorithm.Run(1000, processes, new Results("", "", 0), null, policy);
+
+    assertEquals(60, result.compuTime);
+    assertEquals(switches, result.contextSwitches);
+    assertArrayEquals(turnaround, Arrays.copyOf(processes.turnaround, processes.size()));
+  }
+
+  // Quantum 10: 0 to 10, 1 completes at 20, 2 to 30, 0 to 40,
+  // 2 completes at 50, 0 completes at 60
+  @Test
+  public void roundRobin()
+  {
+    check(new RoundRobin(10), 5, new int[] {60, 20, 50});
+  }
+
+  // Quantum 10 doubles per level: 0 to 10 and down, 1 completes at
+  // 20, 2 to 30 and down, 0 completes at 50 with quantum 20, 2
+  // completes at 60
+  @Test
+  public void multilevelFeedbackQueue()
+  {
+    check(new MultilevelFeedbackQueue(10, 3), 4, new int[] {50, 20, 60});
+  }
+
+  // 0 completes at 30, 2 at 50, 1 at 60
+  @Test
+  public void priority()
+  {
+    check(new PriorityScheduling(), 2, new int[] {30, 60, 50});
+  }
+
+  // 1 completes at 10, 2 at 30, 0 at 60
+  @Test
+  public void shortestJobFirst()
+  {
+    check(new ShortestJobFirst(), 2, new int[] {60, 10, 30});
+  }
+}
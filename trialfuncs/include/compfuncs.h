@@ -33,4 +33,10 @@ static inline char *symbolic_status(compfunc_status_t status)
 #define DECLARE_COMPFUNC(op, name)			\
 	extern compfunc_status_t  name ## _ ## op(int , TYPE(op) *)
 
+/* Evaluates count values, returns number of evaluated values.
+ * Delay is applied once per batch, as the longest delay of evaluated values.
+ * Evaluation stops before a hanging value, unless it is the first one. */
+#define DECLARE_BATCH_COMPFUNC(op, name)		\
+	extern int name ## _ ## op ## _batch(const int *, int , TYPE(op) *, compfunc_status_t *)
+
 #endif // _OS_LAB1_COMPFUNCS_H
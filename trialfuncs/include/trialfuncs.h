@@ -7,17 +7,99 @@
 # define LAB1_EXPORTS
 #endif
 #include <stdio.h>
+#include <stdint.h>
 
 #define DECLARE_FUNCS(op)			\
 	LAB1_EXPORTS DECLARE_COMPFUNC(op, trial_f);		\
-	LAB1_EXPORTS DECLARE_COMPFUNC(op, trial_g)		
-
-DECLARE_FUNCS(and);
-DECLARE_FUNCS(or);
-DECLARE_FUNCS(imul);
-DECLARE_FUNCS(fmul);
-DECLARE_FUNCS(imin);
-DECLARE_FUNCS(fmin);
+	LAB1_EXPORTS DECLARE_COMPFUNC(op, trial_g);		\
+	LAB1_EXPORTS DECLARE_BATCH_COMPFUNC(op, trial_f);	\
+	LAB1_EXPORTS DECLARE_BATCH_COMPFUNC(op, trial_g)
+
+/* All operations of the library, X(op, OP) - name and upper case name.
+ * Expanded by users to build their own tables, order is stable. */
+#define FOREACH_TRIAL_OP(X)	\
+	X(imul, IMUL)		\
+	X(imin, IMIN)		\
+	X(fmul, FMUL)		\
+	X(and, AND)		\
+	X(or, OR)		\
+	X(fmin, FMIN)
+
+#define _DECLARE_OP_FUNCS(op, OP)	DECLARE_FUNCS(op);
+
+FOREACH_TRIAL_OP(_DECLARE_OP_FUNCS)
+
+/* Virtual clock: delays advance simulated time, shared by processes through
+ * a mapped file, instead of sleeping. Manager creates the clock, calculons attach
+ * to it before the first call of trial functions. Return 0 on success. */
+LAB1_EXPORTS int trial_clock_create(const char *path);
+LAB1_EXPORTS int trial_clock_attach(const char *path);
+
+/* Exact advance of virtual clock: simulated time jumps only when no work is
+ * pending. Running process holds one unit of work: it takes it after blocking wait
+ * for input and gives it back before the wait, trial functions give it back while
+ * they wait for simulated time. Results for manager are work from write to read.
+ * Values for calculon are counted in its inbox by trial_clock_post(), calculon
+ * takes them by trial_clock_take(), they hold the clock only while calculon
+ * doesn't wait for simulated time. Calculon attaches before opening its pipes.
+ * No-op without the clock. */
+LAB1_EXPORTS void trial_clock_work(long long delta);
+LAB1_EXPORTS void trial_clock_post(int pid, long long values);
+LAB1_EXPORTS void trial_clock_take(long long values);
+
+/* Manager quits, the clock jumps regardless of pending work, so workers waiting
+ * for simulated time finish. No-op without the clock. */
+LAB1_EXPORTS void trial_clock_release(void);
+
+/* Case tables file: header, then tables in order of trial_case_table. Table of
+ * count x values holds f and g cases of x = 0, 1, ... count - 1, one after
+ * another. Tables with zero count keep compiled cases. */
+#define TRIAL_CASES_MAGIC	"TFCASES1"
+#define TRIAL_CASE_HANGS	0xffff
+
+enum trial_case_table {
+	TRIAL_CASES_AND,	/* and, or */
+	TRIAL_CASES_IMUL,
+	TRIAL_CASES_IMIN,
+	TRIAL_CASES_FMUL,	/* fmul, fmin */
+	TRIAL_CASES_COUNT
+};
+
+struct trial_cases_header {
+	char magic[8];				/* TRIAL_CASES_MAGIC */
+	uint32_t count[TRIAL_CASES_COUNT];	/* number of x values in table */
+	uint32_t reserved[2];
+};
+
+struct trial_case {
+	uint16_t delay_tenths;	/* TRIAL_CASE_HANGS - computation never ends */
+	uint8_t status;		/* compfunc_status_t */
+	uint8_t reserved[5];
+	union {
+		bool b;
+		int i;
+		unsigned int u;
+		double d;
+	} value;		/* result of successful computation */
+};
+
+/* Map case tables file, lookup of x is O(1). Call before the first call of
+ * trial functions. Return 0 on success. */
+LAB1_EXPORTS int trial_cases_load(const char *path);
+
+/* Fault injection: ';' separated entries [<target>:]<key>=<value>,... Target is
+ * f, g, operation or node_operation (f_imul), all functions if omitted. Keys:
+ * soft, hard, hang - probability of soft fail, hard fail and endless computation,
+ * spike - probability of latency spike, spike_delay - its extra delay in tenths
+ * of second (default 50), seed - key of decisions of every function. Decision
+ * is drawn for every evaluation, it depends only on seed, x and number of
+ * previous evaluations of x in the process, including retries, not on batches
+ * or other values. Return 0 on success. */
+LAB1_EXPORTS int trial_faults_config(const char *spec);
+
+/* Current time in microseconds - simulated one, if the clock is created or
+ * attached, monotonic real time otherwise */
+LAB1_EXPORTS long long trial_clock_usecs(void);
 
 #define TYPESTR_and	bool
 #define TYPESTR_or 	bool
@@ -1,8 +1,15 @@
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #ifdef _WIN32
 # include <Windows.h>
 #else
 # include <unistd.h>
+# include <fcntl.h>
+# include <stdatomic.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <time.h>
 #endif
 #include <trialfuncs.h>
 
@@ -36,13 +43,220 @@ DEFINE_CASE_TYPES(int);
 DEFINE_CASE_TYPES(double);
 DEFINE_CASE_TYPES_FULL(unsigned_int, unsigned int);
 
+#ifndef _WIN32
+/* Virtual clock lives in a file, mapped by manager and calculons. Every waiting
+ * process publishes its wake-up time, the clock jumps to the earliest one when
+ * no work is pending: values and results in pipes, processes handling them.
+ * Results come in the same order as in real time, manager reacts to every one
+ * before the next jump. */
+#define VCLOCK_SLOTS		64
+#define VCLOCK_POLL_USECS	100
+#define VCLOCK_IDLE		(-1LL)
+#define VCLOCK_HANGS		(-2LL)
+
+struct _virtual_clock {
+	atomic_llong now;			/* simulated time, usecs */
+	atomic_llong work;			/* pending work, see trial_clock_work() */
+	atomic_int released;			/* manager quit, pending work is ignored */
+	atomic_int lock;			/* jump and publication of wake-up time */
+	atomic_int owners[VCLOCK_SLOTS];	/* pid of attached process, 0 - free slot */
+	atomic_llong wake[VCLOCK_SLOTS];	/* simulated wake-up time, VCLOCK_IDLE if not waiting, VCLOCK_HANGS forever */
+	atomic_llong inbox[VCLOCK_SLOTS];	/* values in input pipe, they hold the clock if process doesn't wait */
+};
+
+static struct _virtual_clock *vclock;
+static int vclock_slot = -1;
+
+static long long real_usecs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static int map_clock(const char *path, int flags)
+{
+	int fd = open(path, flags, 0600);
+	void *mem;
+
+	if (fd == -1)
+		return -1;
+	if ((flags & O_CREAT) && ftruncate(fd, sizeof *vclock) == -1) {
+		close(fd);
+		return -1;
+	}
+	mem = mmap(NULL, sizeof *vclock, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED)
+		return -1;
+
+	if (vclock)
+		munmap(vclock, sizeof *vclock);
+	vclock = mem;
+	return 0;
+}
+
+static void clock_lock(void)
+{
+	int unlocked = 0;
+
+	while (! atomic_compare_exchange_weak(&vclock->lock, &unlocked, 1))
+		unlocked = 0;
+}
+
+static void clock_unlock(void)
+{
+	atomic_store(&vclock->lock, 0);
+}
+
+/* Jump to the earliest wake-up time, if no work is pending, every woken
+ * process took its work back and every process, which doesn't wait for the
+ * clock, read its input. Return 0 if the clock didn't move. */
+static int clock_advance(void)
+{
+	int released = atomic_load(&vclock->released);
+	int moved = 0;
+
+	clock_lock();
+	if (atomic_load(&vclock->work) == 0 || released) {
+		long long now = atomic_load(&vclock->now);
+		long long next = VCLOCK_IDLE;
+
+		for (int i = 0; i < VCLOCK_SLOTS; i++) {
+			long long w = atomic_load(&vclock->wake[i]);
+			if (atomic_load(&vclock->owners[i]) == 0)
+				continue;
+			if (w == VCLOCK_IDLE && atomic_load(&vclock->inbox[i]) > 0 && ! released) {
+				next = VCLOCK_IDLE;
+				break;
+			}
+			if (w >= 0 && (next == VCLOCK_IDLE || w < next))
+				next = w;
+		}
+		if (next > now) {
+			atomic_store(&vclock->now, next);
+			moved = 1;
+		}
+	}
+	clock_unlock();
+	return moved;
+}
+
+/* Caller holds its unit of work, waiting process releases it */
+static void virtual_delay(long long usecs)
+{
+	long long wake;
+
+	clock_lock();
+	wake = atomic_load(&vclock->now) + usecs;
+	atomic_store(&vclock->wake[vclock_slot], wake);
+	clock_unlock();
+	atomic_fetch_sub(&vclock->work, 1);
+
+	while (atomic_load(&vclock->now) < wake)
+		if (! clock_advance())
+			usleep(VCLOCK_POLL_USECS);
+
+	/* Published wake-up time holds the clock, until the work is taken back */
+	atomic_fetch_add(&vclock->work, 1);
+	atomic_store(&vclock->wake[vclock_slot], VCLOCK_IDLE);
+}
+#endif
+
+int trial_clock_create(const char *path)
+{
+#ifdef _WIN32
+	return -1;
+#else
+	if (map_clock(path, O_RDWR | O_CREAT | O_TRUNC))
+		return -1;
+	return 0;
+#endif
+}
+
+int trial_clock_attach(const char *path)
+{
+#ifdef _WIN32
+	return -1;
+#else
+	if (map_clock(path, O_RDWR))
+		return -1;
+	for (int i = 0; i < VCLOCK_SLOTS; i++) {
+		int free_slot = 0;
+		if (atomic_compare_exchange_strong(&vclock->owners[i], &free_slot, getpid())) {
+			atomic_store(&vclock->wake[i], VCLOCK_IDLE);
+			atomic_store(&vclock->inbox[i], 0);
+			vclock_slot = i;
+			return 0;
+		}
+	}
+	munmap(vclock, sizeof *vclock);
+	vclock = NULL;
+	return -1;
+#endif
+}
+
+void trial_clock_work(long long delta)
+{
+#ifndef _WIN32
+	if (vclock)
+		atomic_fetch_add(&vclock->work, delta);
+#endif
+}
+
+void trial_clock_post(int pid, long long values)
+{
+#ifndef _WIN32
+	for (int i = 0; vclock && i < VCLOCK_SLOTS; i++) {
+		if (atomic_load(&vclock->owners[i]) == pid) {
+			atomic_fetch_add(&vclock->inbox[i], values);
+			break;
+		}
+	}
+#endif
+}
+
+void trial_clock_take(long long values)
+{
+#ifndef _WIN32
+	if (vclock_slot != -1)
+		atomic_fetch_sub(&vclock->inbox[vclock_slot], values);
+#endif
+}
+
+void trial_clock_release(void)
+{
+#ifndef _WIN32
+	if (vclock)
+		atomic_store(&vclock->released, 1);
+#endif
+}
+
+long long trial_clock_usecs(void)
+{
+#ifdef _WIN32
+	return GetTickCount64() * 1000;
+#else
+	return vclock ? atomic_load(&vclock->now) : real_usecs();
+#endif
+}
+
 static inline void computational_delay(func_attrs_base_t *delay)
 {
 #ifdef _WIN32
 	Sleep(delay? TENTHS_TO_MILLIS(delay->delay_tenths) : INFINITE);
 #else
-	if (! delay)
+	if (! delay && vclock_slot != -1) {
+		/* Endless computation doesn't hold the clock */
+		atomic_store(&vclock->wake[vclock_slot], VCLOCK_HANGS);
+		atomic_fetch_sub(&vclock->work, 1);
+		pause();
+		atomic_fetch_add(&vclock->work, 1);
+		atomic_store(&vclock->wake[vclock_slot], VCLOCK_IDLE);
+	} else if (! delay)
 		pause();
+	else if (vclock_slot != -1)
+		virtual_delay(TENTHS_TO_USECS(delay->delay_tenths));
 	else
 		usleep(TENTHS_TO_USECS(delay->delay_tenths));
 #endif
@@ -52,18 +266,263 @@ bool index_inside_bounds(unsigned int index, unsigned int size) {
 	return index < size;
 }
 
+#define NODE_f	0
+#define NODE_g	1
+
+/* Status of x for node f or g, CASE_HANGS if computation never ends.
+ * Delay is set unless computation hangs, value only for successful result */
+#define CASE_HANGS	(-1)
+
+/* Fault injection, state of every function of f and g. The or functions are
+ * computed by and ones, they share faults. */
+enum { FAULT_and, FAULT_imul, FAULT_imin, FAULT_fmul, FAULT_fmin, FAULT_OPS_COUNT };
+
+static const char *fault_ops[FAULT_OPS_COUNT] = { "and", "imul", "imin", "fmul", "fmin" };
+
+enum { FK_SOFT, FK_HARD, FK_HANG, FK_SPIKE, FK_SPIKE_DELAY, FK_SEED, FK_COUNT };
+
+static const char *fault_keys[FK_COUNT] = { "soft", "hard", "hang", "spike", "spike_delay", "seed" };
+
+#define FAULT_SEED		25
+#define FAULT_SPIKE_TENTHS	50
+
+struct _fault_state {
+	bool enabled;
+	double soft_fail;	/* probability of soft fail */
+	double hard_fail;	/* probability of hard fail */
+	double hang;		/* probability of endless computation */
+	double spike;		/* probability of latency spike */
+	int spike_tenths;	/* extra delay of spike */
+	unsigned long long seed;	/* key of the function, combined with x and occurrence */
+	struct _fault_occurrence *occurrences;	/* evaluations of x, open addressing, NULL if none */
+	unsigned int occurrences_size;	/* power of 2 */
+	unsigned int occurrences_count;
+};
+
+/* Number of evaluations of x, repeated value and retry draw again */
+struct _fault_occurrence {
+	int x;
+	unsigned int count;	/* 0 - free slot */
+};
+
+static struct _fault_state faults[FAULT_OPS_COUNT][2];
+
+/* splitmix64 finalizer */
+static unsigned long long fault_mix(unsigned long long z)
+{
+	z += 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/* Decision is a function of seed, x, occurrence and draw, it doesn't depend on
+ * batches and other values */
+static double fault_random(const struct _fault_state *fs, int x, unsigned int occurrence, int draw)
+{
+	unsigned long long key = ((unsigned long long) (unsigned int) x << 32) | (occurrence << 1) | draw;
+	unsigned long long z = fault_mix(fs->seed ^ fault_mix(key));
+
+	return (z >> 11) * (1.0 / (1ULL << 53));
+}
+
+/* Every function gets its own key from the seed */
+static unsigned long long fault_stream(unsigned long long seed, int op, int node)
+{
+	return fault_mix(seed * 2 * FAULT_OPS_COUNT + 2 * op + node);
+}
+
+static struct _fault_occurrence *fault_occurrence_slot(const struct _fault_state *fs, int x)
+{
+	unsigned int mask = fs->occurrences_size - 1;
+	unsigned int i = (unsigned int) fault_mix((unsigned int) x) & mask;
+
+	while (fs->occurrences[i].count && fs->occurrences[i].x != x)
+		i = (i + 1) & mask;
+	return &fs->occurrences[i];
+}
+
+/* Count evaluation of x, return the number of its evaluations before. The
+ * probability is a rate per evaluation, repeats of x don't share the fault.
+ * Without memory the evaluation repeats the last fault */
+static unsigned int fault_occurrence(struct _fault_state *fs, int x)
+{
+	struct _fault_occurrence *slot;
+
+	if (2 * (fs->occurrences_count + 1) > fs->occurrences_size) {
+		unsigned int size = fs->occurrences_size ? 2 * fs->occurrences_size : 1024;
+		struct _fault_occurrence *old = fs->occurrences;
+		unsigned int old_size = fs->occurrences_size;
+
+		fs->occurrences = calloc(size, sizeof(*fs->occurrences));
+		if (! fs->occurrences) {
+			fs->occurrences = old;
+			return old ? fault_occurrence_slot(fs, x)->count : 0;
+		}
+		fs->occurrences_size = size;
+		for (unsigned int i = 0; i < old_size; i++)
+			if (old[i].count)
+				*fault_occurrence_slot(fs, old[i].x) = old[i];
+		free(old);
+	}
+
+	slot = fault_occurrence_slot(fs, x);
+	if (! slot->count) {
+		slot->x = x;
+		fs->occurrences_count++;
+	}
+	return slot->count++;
+}
+
+/* Replace status of computed case by injected fault, add latency spike */
+static int inject_fault(struct _fault_state *fs, int x, int status, int *delay_tenths)
+{
+	unsigned int occurrence;
+	double u;
+
+	if (! fs->enabled || status == CASE_HANGS)
+		return status;
+
+	occurrence = fault_occurrence(fs, x);
+	if (fault_random(fs, x, occurrence, 0) < fs->spike)
+		*delay_tenths += fs->spike_tenths;
+
+	u = fault_random(fs, x, occurrence, 1);
+	if (u < fs->hang)
+		return CASE_HANGS;
+	if (u < fs->hang + fs->hard_fail)
+		return COMPFUNC_HARD_FAIL;
+	if (u < fs->hang + fs->hard_fail + fs->soft_fail)
+		return COMPFUNC_SOFT_FAIL;
+	return status;
+}
+
+/* Target of settings: f, g, operation or node_operation, empty for all */
+static int parse_fault_target(const char *target, size_t len, int *op, int *node)
+{
+	*op = -1;
+	*node = -1;
+	if (len >= 1 && (target[0] == 'f' || target[0] == 'g') && (len == 1 || target[1] == '_')) {
+		*node = target[0] == 'g';
+		target += len == 1 ? 1 : 2;
+		len -= len == 1 ? 1 : 2;
+	}
+	if (len == 0)
+		return 0;
+	if (len == 2 && strncmp(target, "or", 2) == 0) {
+		*op = FAULT_and;
+		return 0;
+	}
+	for (int i = 0; i < FAULT_OPS_COUNT; i++)
+		if (strlen(fault_ops[i]) == len && strncmp(target, fault_ops[i], len) == 0)
+			*op = i;
+	return *op == -1 ? -1 : 0;
+}
+
+static int parse_fault_entry(const char *entry, size_t len)
+{
+	const char *end = entry + len;
+	const char *colon = memchr(entry, ':', len);
+	double values[FK_COUNT];
+	unsigned int set = 0;
+	int op, node;
+
+	if (parse_fault_target(entry, colon ? (size_t) (colon - entry) : 0, &op, &node))
+		return -1;
+	if (colon)
+		entry = colon + 1;
+
+	while (entry < end) {
+		size_t n = strcspn(entry, ",;");
+		const char *eq = memchr(entry, '=', n);
+		char *stop;
+		int key;
+
+		if (! eq)
+			return -1;
+		for (key = 0; key < FK_COUNT; key++)
+			if (strlen(fault_keys[key]) == (size_t) (eq - entry)
+			    && strncmp(entry, fault_keys[key], eq - entry) == 0)
+				break;
+		if (key == FK_COUNT)
+			return -1;
+		values[key] = strtod(eq + 1, &stop);
+		if (stop != entry + n || values[key] < 0 || (key < FK_SPIKE_DELAY && values[key] > 1))
+			return -1;
+		set |= 1u << key;
+		entry += n + (entry + n < end);
+	}
+
+	for (int i = 0; i < FAULT_OPS_COUNT; i++) {
+		for (int j = 0; j < 2; j++) {
+			struct _fault_state *fs = &faults[i][j];
+
+			if ((op != -1 && op != i) || (node != -1 && node != j))
+				continue;
+			if (! fs->enabled) {
+				fs->enabled = true;
+				fs->spike_tenths = FAULT_SPIKE_TENTHS;
+				fs->seed = fault_stream(FAULT_SEED, i, j);
+			}
+			if (set & (1u << FK_SOFT))
+				fs->soft_fail = values[FK_SOFT];
+			if (set & (1u << FK_HARD))
+				fs->hard_fail = values[FK_HARD];
+			if (set & (1u << FK_HANG))
+				fs->hang = values[FK_HANG];
+			if (set & (1u << FK_SPIKE))
+				fs->spike = values[FK_SPIKE];
+			if (set & (1u << FK_SPIKE_DELAY))
+				fs->spike_tenths = (int) values[FK_SPIKE_DELAY];
+			if (set & (1u << FK_SEED))
+				fs->seed = fault_stream((unsigned long long) values[FK_SEED], i, j);
+			if (fs->soft_fail + fs->hard_fail + fs->hang > 1)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+int trial_faults_config(const char *spec)
+{
+	while (*spec) {
+		size_t len = strcspn(spec, ";");
+
+		if (len && parse_fault_entry(spec, len))
+			return -1;
+		spec += len + (spec[len] == ';');
+	}
+	return 0;
+}
+
 #define DEFINE_COMP_FUNC(name, op) 								\
 	compfunc_status_t trial_ ## name ## _ ## op(int x, TYPE(op) *valuep) {			\
-		if (index_inside_bounds(x, sizeof cases_##op / sizeof cases_##op[0])) {		\
-			computational_delay(& cases_##op[x].name##_attrs->delay);		\
-			if (cases_##op[x].name##_attrs->result) {				\
-				*valuep = cases_##op[x].name##_attrs->result->value;		\
-				return COMPFUNC_SUCCESS;					\
-			} 									\
-		} 										\
-		return COMPFUNC_HARD_FAIL;							\
+		func_attrs_base_t delay = { .delay_tenths = 0 };				\
+		int status = lookup_##op(NODE_##name, x, &delay.delay_tenths, valuep);		\
+		status = inject_fault(&faults[FAULT_##op][NODE_##name], x, status, &delay.delay_tenths);	\
+		computational_delay(status == CASE_HANGS ? NULL : &delay);			\
+		return status;									\
 	}										
 
+#define DEFINE_BATCH_COMP_FUNC(name, op)							\
+	int trial_ ## name ## _ ## op ## _batch(const int *xs, int count, TYPE(op) *values,	\
+						compfunc_status_t *statuses) {			\
+		func_attrs_base_t delay = { .delay_tenths = 0 };				\
+		int done, status, tenths;							\
+		for (done = 0; done < count; done++) {						\
+			tenths = 0;								\
+			status = lookup_##op(NODE_##name, xs[done], &tenths, &values[done]);	\
+			status = inject_fault(&faults[FAULT_##op][NODE_##name], xs[done], status, &tenths);	\
+			if (status == CASE_HANGS)						\
+				break;								\
+			if (tenths > delay.delay_tenths)					\
+				delay.delay_tenths = tenths;					\
+			statuses[done] = status;						\
+		}										\
+		computational_delay(done == 0 && count > 0 ? NULL : &delay);			\
+		return done;									\
+	}
+
 
 #define _DEFINE_CASES_FULL(op, typestr) \
     	static _CF_T(case, typestr) cases_##op[]
@@ -86,13 +545,116 @@ DEFINE_CASES(imul) = { NUMERIC_CASES_INIT(int) };
 DEFINE_CASES(imin) = { NUMERIC_CASES_INIT(unsigned_int) };
 DEFINE_CASES(fmul) = { NUMERIC_CASES_INIT(double) };
 
-static case_double_t *cases_fmin = cases_fmul;
+/* Case tables loaded by trial_cases_load(), replace compiled ones */
+struct _case_table {
+	const struct trial_case *cases;	/* f and g case of every x, NULL - compiled table is used */
+	unsigned int count;		/* number of x values */
+};
+
+static struct _case_table loaded_cases[TRIAL_CASES_COUNT];
+
+#define TABLE_and	TRIAL_CASES_AND
+#define TABLE_imul	TRIAL_CASES_IMUL
+#define TABLE_imin	TRIAL_CASES_IMIN
+#define TABLE_fmul	TRIAL_CASES_FMUL
+
+#define CASE_VALUE_and(c)	((c)->value.b)
+#define CASE_VALUE_imul(c)	((c)->value.i)
+#define CASE_VALUE_imin(c)	((c)->value.u)
+#define CASE_VALUE_fmul(c)	((c)->value.d)
+
+#define DEFINE_CASE_LOOKUP(op)									\
+	static int lookup_##op(int node, int x, int *delay_tenths, TYPE(op) *valuep) {		\
+		const struct _case_table *table = &loaded_cases[TABLE_##op];			\
+		const CF_T(func_attrs, TYPESTR(op)) *attrs;						\
+		if (table->cases) {								\
+			const struct trial_case *c;						\
+			if (! index_inside_bounds(x, table->count))				\
+				return COMPFUNC_HARD_FAIL;					\
+			c = &table->cases[2 * (unsigned int) x + node];				\
+			if (c->delay_tenths == TRIAL_CASE_HANGS)				\
+				return CASE_HANGS;						\
+			*delay_tenths = c->delay_tenths;					\
+			if (c->status == COMPFUNC_SUCCESS)					\
+				*valuep = CASE_VALUE_##op(c);					\
+			return c->status < COMPFUNC_STATUS_MAX ? c->status : COMPFUNC_HARD_FAIL;	\
+		}										\
+		if (! index_inside_bounds(x, sizeof cases_##op / sizeof cases_##op[0]))		\
+			return COMPFUNC_HARD_FAIL;						\
+		attrs = node == NODE_f ? cases_##op[x].f_attrs : cases_##op[x].g_attrs;		\
+		if (! attrs)									\
+			return CASE_HANGS;							\
+		*delay_tenths = attrs->delay.delay_tenths;					\
+		if (! attrs->result)								\
+			return COMPFUNC_HARD_FAIL;						\
+		*valuep = attrs->result->value;							\
+		return COMPFUNC_SUCCESS;							\
+	}
 
-#define DEFINE_ALL_BUT_OR(name)	\
-	DEFINE_COMP_FUNC(name, and)	\
-	DEFINE_COMP_FUNC(name, imul)	\
-	DEFINE_COMP_FUNC(name, fmul)	\
-	DEFINE_COMP_FUNC(name, imin)
+DEFINE_CASE_LOOKUP(and)
+DEFINE_CASE_LOOKUP(imul)
+DEFINE_CASE_LOOKUP(imin)
+DEFINE_CASE_LOOKUP(fmul)
+
+/* fmin shares cases with fmul */
+#define lookup_fmin	lookup_fmul
+
+int trial_cases_load(const char *path)
+{
+#ifdef _WIN32
+	return -1;
+#else
+	const struct trial_cases_header *header;
+	const struct trial_case *cases;
+	unsigned long long total = 0;
+	struct stat st;
+	void *mem;
+	int fd = open(path, O_RDONLY);
+
+	if (fd == -1)
+		return -1;
+	if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof *header) {
+		close(fd);
+		return -1;
+	}
+	mem = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED)
+		return -1;
+
+	header = mem;
+	for (int i = 0; i < TRIAL_CASES_COUNT; i++)
+		total += header->count[i];
+	if (memcmp(header->magic, TRIAL_CASES_MAGIC, sizeof header->magic) != 0
+	    || sizeof *header + total * 2 * sizeof *cases > (unsigned long long) st.st_size) {
+		munmap(mem, st.st_size);
+		return -1;
+	}
+
+	/* Tables follow the header in order of trial_case_table, lookup by x is direct */
+	cases = (const struct trial_case *) (header + 1);
+	for (int i = 0; i < TRIAL_CASES_COUNT; i++) {
+		if (header->count[i]) {
+			loaded_cases[i].cases = cases;
+			loaded_cases[i].count = header->count[i];
+		}
+		cases += 2 * (size_t) header->count[i];
+	}
+	return 0;
+#endif
+}
+
+#define DEFINE_ALL_BUT_OR(name)		\
+	DEFINE_COMP_FUNC(name, and)		\
+	DEFINE_COMP_FUNC(name, imul)		\
+	DEFINE_COMP_FUNC(name, fmul)		\
+	DEFINE_COMP_FUNC(name, imin)		\
+	DEFINE_COMP_FUNC(name, fmin)		\
+	DEFINE_BATCH_COMP_FUNC(name, and)	\
+	DEFINE_BATCH_COMP_FUNC(name, imul)	\
+	DEFINE_BATCH_COMP_FUNC(name, fmul)	\
+	DEFINE_BATCH_COMP_FUNC(name, imin)	\
+	DEFINE_BATCH_COMP_FUNC(name, fmin)
 
 DEFINE_ALL_BUT_OR(f)
 DEFINE_ALL_BUT_OR(g)
@@ -113,3 +675,20 @@ compfunc_status_t trial_g_or(int x, bool *valuep) {
 	return status;
 }
 
+int trial_f_or_batch(const int *xs, int count, bool *values, compfunc_status_t *statuses) {
+	int done = trial_f_and_batch(xs, count, values, statuses);
+	for (int i = 0; i < done; i++)
+		if (statuses[i] == COMPFUNC_SUCCESS)
+			values[i] = !values[i];
+
+	return done;
+}
+
+int trial_g_or_batch(const int *xs, int count, bool *values, compfunc_status_t *statuses) {
+	int done = trial_g_and_batch(xs, count, values, statuses);
+	for (int i = 0; i < done; i++)
+		if (statuses[i] == COMPFUNC_SUCCESS)
+			values[i] = !values[i];
+
+	return done;
+}